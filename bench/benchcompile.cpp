@@ -0,0 +1,80 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ benchcompile.cpp -O3 -std=c++17 -o benchcompile
+    ./benchcompile <compiler> <include_dir> [rounds]
+```
+Compare the compile time (-fsyntax-only) of the same translation unit,
+reading and writing a midi file, when it includes the umbrella MiniMidi.hpp
+or only Core.hpp, against an empty translation unit. The CMake target
+passes the compiler and the include directory of the build.
+*/
+
+#include<iostream>
+#include<fstream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include<cstdlib>
+#include<algorithm>
+#include<filesystem>
+
+using namespace std;
+
+namespace fs = std::filesystem;
+
+// median wall time of compiling the source, in milliseconds
+double bench(const string &compiler, const string &includeDir, const fs::path &source, const size_t rounds) {
+    const string command = compiler + " -std=c++17 -fsyntax-only -I\"" + includeDir + "\" \"" + source.string() + "\"";
+    vector<double> times;
+    for (size_t r = 0; r < rounds; ++r) {
+        const auto begin = chrono::steady_clock::now();
+        if (system(command.c_str()) != 0) {
+            cout << "Compiling " << source << " failed." << endl;
+            return 0;
+        }
+        times.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count());
+    }
+    sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+int main(int argc, char *argv[]) {
+#if defined(MINIMIDI_CXX) && defined(MINIMIDI_INCLUDE_DIR)
+    const string compiler = argc >= 3 ? argv[1] : MINIMIDI_CXX;
+    const string includeDir = argc >= 3 ? argv[2] : MINIMIDI_INCLUDE_DIR;
+#else
+    if (argc < 3) {
+        std::cout << "Usage: ./benchcompile <compiler> <include_dir> [rounds]" << std::endl;
+        return 0;
+    }
+    const string compiler = argv[1];
+    const string includeDir = argv[2];
+#endif
+    const size_t rounds = argc == 4 ? stoul(argv[3]) : 5;
+
+    const string body =
+        "using namespace minimidi;\n"
+        "int main(int argc, char *argv[]) {\n"
+        "    file::MidiFile midiFile = file::MidiFile::from_file(argv[1]);\n"
+        "    midiFile.tracks[0].messages.emplace_back(message::Message::NoteOn(0, 0, 60, 100));\n"
+        "    midiFile.write_file(argv[2]);\n"
+        "    return 0;\n"
+        "}\n";
+    const fs::path dir = fs::temp_directory_path() / "minimidi_benchcompile";
+    fs::create_directories(dir);
+    const vector<pair<string, string>> sources = {
+        {"empty", "int main() { return 0; }\n"},
+        {"Core.hpp", "#include\"minimidi/Core.hpp\"\n" + body},
+        {"MiniMidi.hpp", "#include\"minimidi/MiniMidi.hpp\"\n" + body},
+    };
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const fs::path source = dir / ("tu" + to_string(i) + ".cpp");
+        ofstream(source) << sources[i].second;
+        cout << sources[i].first << ": " << bench(compiler, includeDir, source, rounds) << " ms" << endl;
+    }
+    fs::remove_all(dir);
+
+    return 0;
+}
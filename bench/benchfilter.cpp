@@ -0,0 +1,69 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ benchfilter.cpp -O3 -std=c++17 -I../include -pthread -o benchfilter
+    ./benchfilter <midi_file_name> [repeat]
+```
+Compare std::function filter_message, templated filter_message,
+Track::erase_if and parallel::filter_message on all messages of a file
+concatenated `repeat` times into a single track.
+*/
+
+#include<iostream>
+#include<string>
+#include<chrono>
+#include<functional>
+#include"minimidi/MiniMidi.hpp"
+#include"minimidi/Parallel.hpp"
+
+using namespace std;
+using namespace minimidi;
+
+template<typename Func>
+double bench(const string &name, const size_t rounds, Func &&func) {
+    size_t kept = 0;
+    const auto begin = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) kept += func();
+    const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count() / rounds;
+    cout << name << ": " << ms << " ms (kept " << kept / rounds << ")" << endl;
+    return ms;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc == 2 || argc == 3) {
+        const file::MidiFile midiFile = file::MidiFile::from_file(argv[1]);
+        const size_t repeat = argc == 3 ? stoul(argv[2]) : 20;
+        const size_t rounds = 10;
+
+        message::Messages messages;
+        for (size_t r = 0; r < repeat; ++r) {
+            for (const auto &track: midiFile.tracks)
+                messages.insert(messages.end(), track.messages.begin(), track.messages.end());
+        }
+        cout << "Messages: " << messages.size() << endl;
+
+        const auto isNote = [](const message::Message &msg) {
+            return msg.get_type() == message::MessageType::NoteOn || msg.get_type() == message::MessageType::NoteOff;
+        };
+        const std::function<bool(const message::Message &)> isNoteFunc = isNote;
+
+        bench("filter_message (std::function)", rounds, [&]() {
+            return message::filter_message(messages, isNoteFunc).size();
+        });
+        bench("filter_message (template)", rounds, [&]() {
+            return message::filter_message(messages, isNote).size();
+        });
+        bench("Track::erase_if (copy + erase)", rounds, [&]() {
+            track::Track track{message::Messages(messages)};
+            track.erase_if([&](const message::Message &msg) { return !isNote(msg); });
+            return track.message_num();
+        });
+        bench("parallel::filter_message", rounds, [&]() {
+            return parallel::filter_message(messages, isNote).size();
+        });
+    } else {
+        std::cout << "Usage: ./benchfilter <midi_file_name> [repeat]" << std::endl;
+    }
+
+    return 0;
+}
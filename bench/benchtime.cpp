@@ -0,0 +1,69 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ benchtime.cpp -O3 -std=c++17 -I../include -o benchtime
+    g++ benchtime.cpp -O3 -std=c++17 -I../include -DMINIMIDI_TIME_TYPE=uint64_t -o benchtime64
+    ./benchtime <midi_file_name> [rounds]
+```
+Measure the cost of the message time type: the size of a message, the memory
+taken by the messages of a file, the parse time and a sweep over all times.
+Run both builds on the same file to compare uint32_t with uint64_t.
+*/
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include<chrono>
+#include"minimidi/Core.hpp"
+
+using namespace std;
+using namespace minimidi;
+
+int main(int argc, char *argv[]) {
+    if(argc == 2 || argc == 3) {
+        FILE *filePtr = fopen(argv[1], "rb");
+        if (!filePtr) return EXIT_FAILURE;
+        fseek(filePtr, 0, SEEK_END);
+        container::Bytes data(ftell(filePtr));
+        fseek(filePtr, 0, SEEK_SET);
+        data.resize(fread(data.data(), 1, data.size(), filePtr));
+        fclose(filePtr);
+        const size_t rounds = argc == 3 ? stoul(argv[2]) : 50;
+
+        double parseBest = 1e30;
+        file::MidiFile midiFile;
+        for (size_t r = 0; r < rounds; ++r) {
+            const auto begin = chrono::steady_clock::now();
+            midiFile = file::MidiFile(data);
+            parseBest = min(parseBest, chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count());
+        }
+
+        size_t messageNum = 0, capacity = 0;
+        for (const auto &track: midiFile.tracks) {
+            messageNum += track.message_num();
+            capacity += track.messages.capacity();
+        }
+
+        double sweepBest = 1e30;
+        message::Time lastTime = 0;
+        for (size_t r = 0; r < rounds; ++r) {
+            const auto begin = chrono::steady_clock::now();
+            lastTime = 0;
+            for (const auto &track: midiFile.tracks) {
+                for (const auto &msg: track.messages) lastTime = max(lastTime, msg.get_time());
+            }
+            sweepBest = min(sweepBest, chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count());
+        }
+
+        cout << "Time type: " << sizeof(message::Time) * 8 << " bits" << endl;
+        cout << "sizeof(Message): " << sizeof(message::Message) << " bytes" << endl;
+        cout << "Messages: " << messageNum << ", last tick: " << lastTime << endl;
+        cout << "Message memory: " << capacity * sizeof(message::Message) / 1024. << " KiB" << endl;
+        cout << "Parse: " << parseBest << " ms, " << messageNum / parseBest / 1e3 << " M messages/s" << endl;
+        cout << "Time sweep: " << sweepBest << " ms" << endl;
+    } else {
+        std::cout << "Usage: ./benchtime <midi_file_name> [rounds]" << std::endl;
+    }
+
+    return 0;
+}
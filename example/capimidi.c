@@ -0,0 +1,64 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    ./capimidi <source_midifile>.mid <target_midifile>.mid
+```
+Copy a midi file event by event through the C API, without any allocation
+besides the two file buffers.
+*/
+
+#include<stdio.h>
+#include<stdlib.h>
+#include"minimidi/minimidi_c.h"
+
+int main(int argc, char *argv[]) {
+    if(argc != 3) {
+        printf("Usage: ./capimidi <source_midifile>.mid <target_midifile>.mid\n");
+        return 0;
+    }
+
+    FILE *src = fopen(argv[1], "rb");
+    if(!src) return EXIT_FAILURE;
+    fseek(src, 0, SEEK_END);
+    const size_t size = (size_t)ftell(src);
+    fseek(src, 0, SEEK_SET);
+    uint8_t *in = (uint8_t *)malloc(size);
+    const size_t readSize = fread(in, 1, size, src);
+    fclose(src);
+
+    // a copy never needs more than the source size plus an end of track per track
+    const size_t capacity = readSize + 65536 * 4;
+    uint8_t *out = (uint8_t *)malloc(capacity);
+
+    mm_file file;
+    mm_track track;
+    mm_event event;
+    mm_writer writer;
+    mm_status status = mm_file_open(&file, in, readSize);
+    size_t eventNum = 0, outSize = 0;
+    if(status == MM_OK) status = mm_writer_init(&writer, out, capacity, file.format, file.division);
+    while(status == MM_OK && (status = mm_file_next_track(&file, &track)) == MM_OK) {
+        status = mm_writer_begin_track(&writer);
+        while(status == MM_OK && (status = mm_track_next_event(&track, &event)) == MM_OK) {
+            status = mm_writer_write_event(&writer, &event);
+            ++eventNum;
+        }
+        if(status == MM_END) status = mm_writer_end_track(&writer);
+    }
+    if(status == MM_END) status = mm_writer_finish(&writer, &outSize);
+
+    if(status == MM_OK) {
+        FILE *dst = fopen(argv[2], "wb");
+        if(dst) {
+            fwrite(out, 1, outSize, dst);
+            fclose(dst);
+        }
+        printf("Copied %zu events, %zu -> %zu bytes.\n", eventNum, readSize, outSize);
+    } else {
+        printf("Failed: %s\n", mm_status_string(status));
+    }
+
+    free(in);
+    free(out);
+    return status == MM_OK ? 0 : EXIT_FAILURE;
+}
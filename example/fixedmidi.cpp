@@ -0,0 +1,83 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ fixedmidi.cpp -O3 -std=c++17 -fno-exceptions -I../include -o fixedmidi
+    ./fixedmidi <source_midifile>.mid
+```
+Parse a midi file into static storage and play it through, printing the notes
+per channel and the duration, without any dynamic allocation.
+*/
+
+#include<cstdio>
+#include<cstdlib>
+#include<new>
+#include"minimidi/Fixed.hpp"
+
+using namespace minimidi;
+
+// every operator new is counted, to show that parsing and playing never allocates
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    ++allocations;
+    if (void *ptr = std::malloc(size)) return ptr;
+    std::abort();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+static uint8_t fileBuffer[1 << 20];
+static fixed::StaticMidiFile<1 << 19, 1 << 21, 64> midiFile;
+
+int main(int argc, char *argv[])
+{
+    if(argc != 2)
+    {
+        std::printf("Usage: ./fixedmidi <source_midifile>.mid\n");
+        return 0;
+    }
+
+    FILE *filePtr = std::fopen(argv[1], "rb");
+    if(!filePtr)
+    {
+        std::printf("Opening %s failed\n", argv[1]);
+        return 1;
+    }
+    const size_t size = std::fread(fileBuffer, 1, sizeof(fileBuffer), filePtr);
+    std::fclose(filePtr);
+
+    const size_t before = allocations;
+    if(const fixed::Status status = midiFile.parse(fileBuffer, size); status != fixed::Status::Ok)
+    {
+        std::printf("Parsing failed: %s\n", fixed::status_to_string(status));
+        return 1;
+    }
+
+    fixed::Player<64> player(midiFile);
+    if(player.status() != fixed::Status::Ok)
+    {
+        std::printf("Playing failed: %s\n", fixed::status_to_string(player.status()));
+        return 1;
+    }
+    size_t notes[16] = {};
+    fixed::MessageView event;
+    uint64_t micros = 0;
+    while(player.next(event, micros))
+    {
+        if(event.get_type() == message::MessageType::NoteOn && event.get_velocity())
+            ++notes[event.get_channel()];
+    }
+
+    std::printf("Tracks: %zu, events: %zu, payload: %zu bytes\n",
+                midiFile.track_num(), midiFile.event_num(), midiFile.payload_size());
+    for(int channel = 0; channel < 16; ++channel)
+    {
+        if(notes[channel]) std::printf("Channel %d: %zu notes\n", channel, notes[channel]);
+    }
+    std::printf("Duration: %.3f s\n", micros / 1e6);
+    std::printf("Allocations while parsing and playing: %zu\n", allocations - before);
+
+    return 0;
+}
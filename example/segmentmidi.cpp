@@ -0,0 +1,34 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ segmentmidi.cpp -O3 -std=c++17 -I../include -o segmentmidi
+    ./segmentmidi <source_midifile>.mid <target_prefix> <bars> <hop_bars>
+```
+*/
+
+#include<iostream>
+#include<string>
+#include"minimidi/MiniMidi.hpp"
+#include"minimidi/Segment.hpp"
+
+using namespace std;
+using namespace minimidi;
+
+int main(int argc, char *argv[]) {
+    if(argc == 5) {
+        const file::MidiFile midiFile = file::MidiFile::from_file(argv[1]);
+        const string prefix = string(argv[2]);
+        const auto windows = segment::bar_windows(midiFile, stoul(argv[3]), stoul(argv[4]));
+
+        size_t idx = 0;
+        segment::for_each_segment(midiFile, windows,
+            [&](const segment::Window &, const file::MidiFile &seg) {
+                file::MidiFile(seg).write_file(prefix + "_" + to_string(idx++) + ".mid");
+            });
+        std::cout << "Wrote " << idx << " segments." << std::endl;
+    } else {
+        std::cout << "Usage: ./segmentmidi <source_midifile>.mid <target_prefix> <bars> <hop_bars>" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ undumpmidi.cpp -O3 -std=c++20 -I../include -o undumpmidi
+    ./undumpmidi <source_textfile>.txt <target_midifile>.mid
+```
+*/
+
+#include<iostream>
+#include<string>
+#include"minimidi/MiniMidi.hpp"
+#include"minimidi/Dump.hpp"
+
+using namespace std;
+using namespace minimidi;
+
+
+void write_file(const string& from, const string& to)
+{
+    file::MidiFile midiFile = dump::read_file(from);
+    midiFile.write_file(to);
+};
+
+int main(int argc, char *argv[])
+{
+    if(argc == 3)
+    {
+        string source_dir = string(argv[1]);
+        string target_dir = string(argv[2]);
+
+        write_file(source_dir, target_dir);
+    }
+    else
+    {
+        std::cout << "Usage: ./undumpmidi <source_textfile>.txt <target_midifile>.mid" << std::endl;
+    }
+
+    return 0;
+}
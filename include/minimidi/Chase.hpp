@@ -0,0 +1,237 @@
+#ifndef MINIMIDI_CHASE_HPP
+#define MINIMIDI_CHASE_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<cstring>
+#include<vector>
+#include<algorithm>
+#include<stdexcept>
+#include"Core.hpp"
+#include"Timing.hpp"
+
+namespace minimidi {
+
+namespace chase {
+
+// value of a program, pressure or controller that has never been set
+constexpr uint8_t UNSET = 0xFF;
+
+typedef struct {
+    uint8_t program;
+    uint8_t pressure;
+    // 0 while hasPitchBend is false
+    int16_t pitchBend;
+    bool hasPitchBend;
+    // controllers 120-127 are channel mode messages and are not chased
+    uint8_t controls[120];
+    // velocity of every sounding note, 0 for silent
+    uint8_t notes[128];
+} ChannelState;
+
+// The playback state carried forward from tick 0, used by ChaseIndex and segment::for_each_segment.
+class State {
+    // meta events emitted again by emit(), the last one of each type
+    static constexpr message::MetaType CHASED_META[] = {
+        message::MetaType::TrackName,
+        message::MetaType::InstrumentName,
+        message::MetaType::SetTempo,
+        message::MetaType::TimeSignature,
+        message::MetaType::KeySignature,
+    };
+    static constexpr size_t META_NUM = sizeof(CHASED_META) / sizeof(CHASED_META[0]);
+
+    message::Message metas[META_NUM];
+    bool hasMeta[META_NUM]{};
+
+public:
+    uint32_t tempo;
+    message::TimeSignature timeSignature;
+    message::KeySignature keySignature;
+    ChannelState channels[16];
+
+    State(): tempo(timing::DEFAULT_TEMPO), timeSignature{4, 4}, keySignature(0, 0) {
+        for (auto &channel: channels) reset_channel(channel);
+    };
+
+    static void reset_channel(ChannelState &channel) {
+        channel.program = UNSET;
+        channel.pressure = UNSET;
+        channel.pitchBend = 0;
+        channel.hasPitchBend = false;
+        std::memset(channel.controls, UNSET, sizeof(channel.controls));
+        std::memset(channel.notes, 0, sizeof(channel.notes));
+    };
+
+    void apply(const message::Message &msg) {
+        ChannelState &channel = channels[msg.get_channel()];
+        switch (msg.get_type()) {
+            case (message::MessageType::NoteOn): {
+                channel.notes[msg.get_pitch() & 0x7F] = msg.get_velocity();
+                break;
+            };
+            case (message::MessageType::NoteOff): {
+                channel.notes[msg.get_pitch() & 0x7F] = 0;
+                break;
+            };
+            case (message::MessageType::ProgramChange): {
+                channel.program = msg.get_program();
+                break;
+            };
+            case (message::MessageType::ChannelAfterTouch): {
+                channel.pressure = msg.get_data()[0];
+                break;
+            };
+            case (message::MessageType::PitchBend): {
+                channel.pitchBend = msg.get_pitch_bend();
+                channel.hasPitchBend = true;
+                break;
+            };
+            case (message::MessageType::ControlChange): {
+                const uint8_t number = msg.get_control_number() & 0x7F;
+                if (number < 120) {
+                    channel.controls[number] = msg.get_control_value();
+                }
+                // All Sound Off, All Notes Off
+                else if (number == 120 || number == 123) {
+                    std::memset(channel.notes, 0, sizeof(channel.notes));
+                }
+                // Reset All Controllers
+                else if (number == 121) {
+                    std::memset(channel.controls, UNSET, sizeof(channel.controls));
+                    channel.pressure = UNSET;
+                    channel.pitchBend = 0;
+                    channel.hasPitchBend = false;
+                }
+                break;
+            };
+            case (message::MessageType::Meta): {
+                const message::MetaType metaType = msg.get_meta_type();
+                switch (metaType) {
+                    case (message::MetaType::SetTempo): tempo = msg.get_tempo(); break;
+                    case (message::MetaType::TimeSignature): timeSignature = msg.get_time_signature(); break;
+                    case (message::MetaType::KeySignature): keySignature = msg.get_key_signature(); break;
+                    default: break;
+                }
+                for (size_t i = 0; i < META_NUM; ++i) {
+                    if (CHASED_META[i] == metaType) {
+                        metas[i] = msg;
+                        hasMeta[i] = true;
+                        break;
+                    }
+                }
+                break;
+            };
+            default: break;
+        }
+    };
+
+    // Emit the chased meta events, programs, controllers, pressure and pitch bend
+    // needed to start playback at `time`. Sounding notes are not re-struck.
+    void emit(message::Messages &out, const message::Time time = 0) const {
+        for (size_t i = 0; i < META_NUM; ++i) {
+            if (hasMeta[i]) {
+                // copy, keeping interned text
+                out.emplace_back(metas[i]).set_time(time);
+            }
+        }
+        for (uint8_t c = 0; c < 16; ++c) {
+            const ChannelState &channel = channels[c];
+            if (channel.program != UNSET)
+                out.emplace_back(message::Message::ProgramChange(time, c, channel.program));
+            for (uint8_t number = 0; number < 120; ++number) {
+                if (channel.controls[number] != UNSET)
+                    out.emplace_back(message::Message::ControlChange(time, c, number, channel.controls[number]));
+            }
+            if (channel.pressure != UNSET)
+                out.emplace_back(time,
+                    static_cast<uint8_t>(message::message_status<message::MessageType::ChannelAfterTouch>() | c),
+                    container::SmallBytes{channel.pressure});
+            if (channel.hasPitchBend)
+                out.emplace_back(message::Message::PitchBend(time, c, channel.pitchBend));
+        }
+    };
+};
+
+// Checkpoint index over the time-merged events of all tracks of a MidiFile.
+// A full State is stored every `interval` events, so the state at any tick is
+// found by a binary search and the replay of at most `interval` events.
+// The MidiFile must outlive the index and must not be modified.
+class ChaseIndex {
+public:
+    typedef struct {
+        message::Time time;
+        uint32_t track;
+        uint32_t index;
+    } EventRef;
+
+private:
+    const file::MidiFile *midiFile;
+    size_t interval;
+    std::vector<EventRef> events;
+    // checkpoints[k] is the state before events[k * interval]
+    std::vector<State> checkpoints;
+
+public:
+    explicit ChaseIndex(const file::MidiFile &midiFile, const size_t interval = 4096):
+        midiFile(&midiFile), interval(interval) {
+        if (!interval) {
+            throw std::invalid_argument("MiniMidi: Checkpoint interval must be positive!");
+        }
+
+        size_t eventNum = 0;
+        for (const auto &track: midiFile.tracks) eventNum += track.message_num();
+        events.reserve(eventNum);
+        for (uint32_t t = 0; t < midiFile.track_num(); ++t) {
+            const auto &messages = midiFile.tracks[t].messages;
+            for (uint32_t i = 0; i < messages.size(); ++i)
+                events.push_back({messages[i].get_time(), t, i});
+        }
+        // events at the same tick keep the track order
+        std::stable_sort(events.begin(), events.end(),
+            [](const EventRef &a, const EventRef &b) { return a.time < b.time; });
+
+        checkpoints.reserve(events.size() / interval + 1);
+        State state;
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (i % interval == 0) checkpoints.push_back(state);
+            state.apply(event_message(i));
+        }
+        if (checkpoints.empty()) checkpoints.push_back(state);
+    };
+
+    [[nodiscard]] const message::Message &event_message(const size_t idx) const {
+        const EventRef &ref = events[idx];
+        return midiFile->tracks[ref.track].messages[ref.index];
+    };
+
+    [[nodiscard]] const std::vector<EventRef> &merged_events() const {
+        return this->events;
+    };
+
+    // Index of the first merged event after `tick`, where playback resumes.
+    [[nodiscard]] size_t event_index(const message::Time tick) const {
+        return std::upper_bound(events.begin(), events.end(), tick,
+            [](const message::Time t, const EventRef &e) { return t < e.time; }) - events.begin();
+    };
+
+    // State after all events with time <= tick.
+    [[nodiscard]] State state_at(const message::Time tick) const {
+        const size_t end = event_index(tick);
+        const size_t checkpoint = std::min(end / interval, checkpoints.size() - 1);
+        State state = checkpoints[checkpoint];
+        for (size_t i = checkpoint * interval; i < end; ++i)
+            state.apply(event_message(i));
+        return state;
+    };
+
+    [[nodiscard]] size_t checkpoint_num() const {
+        return this->checkpoints.size();
+    };
+};
+
+}
+
+}
+
+#endif //MINIMIDI_CHASE_HPP
@@ -0,0 +1,1609 @@
+#ifndef MINIMIDI_CORE_HPP
+#define MINIMIDI_CORE_HPP
+
+// Parsing and serialization without iostreams; printing is in Print.hpp and filter_message
+// in Filter.hpp, all of them included by MiniMidi.hpp.
+
+// used for ignoring warning C4996 (MSCV): 'fopen' was declared deprecated
+#ifdef _MSC_VER
+#pragma warning(disable:4996)
+#endif
+
+#include<cstdint>
+#include<cstddef>
+#include<cstdio>
+#include<utility>
+#include<vector>
+#include<string>
+#include<ios>
+#include<stdexcept>
+#include<numeric>
+#include<cmath>
+#include<algorithm>
+#include<array>
+#include<optional>
+#include<string_view>
+#include<atomic>
+#include<mutex>
+#include<memory>
+#include<unordered_map>
+#include<type_traits>
+#include"svector.h"
+#include"Types.hpp"
+
+namespace minimidi {
+
+namespace container {
+
+typedef std::vector<uint8_t> Bytes;
+
+// size of SmallBytes is totally 8 bytes on the stack (7 bytes + 1 byte for size)
+typedef ankerl::svector<uint8_t, 7> SmallBytes;
+
+// Non-owning view of contiguous bytes, e.g. the payload of a message (std::span is C++20).
+class ByteView {
+    const uint8_t *ptr = nullptr;
+    size_t length = 0;
+
+public:
+    constexpr ByteView() = default;
+    constexpr ByteView(const uint8_t *data, const size_t size): ptr(data), length(size) {};
+
+    [[nodiscard]] constexpr const uint8_t *data() const { return ptr; };
+
+    [[nodiscard]] constexpr size_t size() const { return length; };
+
+    [[nodiscard]] constexpr bool empty() const { return !length; };
+
+    [[nodiscard]] constexpr const uint8_t *begin() const { return ptr; };
+
+    [[nodiscard]] constexpr const uint8_t *end() const { return ptr + length; };
+
+    constexpr uint8_t operator[](const size_t index) const { return ptr[index]; };
+};
+
+// to_string func for byte views
+inline std::string to_string(const ByteView &data) {
+    // show in hex
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string result = "{ ";
+    result.reserve(3 * data.size() + 3);
+    for (auto &d: data) {
+        result += DIGITS[d >> 4];
+        result += DIGITS[d & 0x0F];
+        result += ' ';
+    }
+    result += '}';
+    return result;
+};
+
+// to_string func for SmallBytes
+inline std::string to_string(const SmallBytes &data) {
+    return to_string(ByteView(data.data(), data.size()));
+};
+
+// Process-wide pool of interned strings, used for meta text repeated across a corpus.
+// Equal handles mean equal strings. Interning is thread-safe and the strings live until
+// the end of the process.
+class StringPool {
+    static constexpr uint32_t BLOCK_BITS = 12;
+    static constexpr uint32_t BLOCK_SIZE = 1u << BLOCK_BITS;
+    static constexpr uint32_t MAX_BLOCK_NUM = 1u << 12;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string_view, uint32_t> index;
+    // strings never move once stored, so the keys of index and returned views stay valid
+    std::array<std::atomic<std::string *>, MAX_BLOCK_NUM> blocks{};
+    // published after the string is stored, get() only reads below it
+    std::atomic<uint32_t> stringNum{0};
+    size_t byteNum = 0;
+
+    StringPool() = default;
+
+public:
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+
+    ~StringPool() {
+        for (auto &block: blocks) delete[] block.load();
+    };
+
+    static StringPool &global() {
+        static StringPool pool;
+        return pool;
+    };
+
+    uint32_t intern(const std::string_view text) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (const auto it = index.find(text); it != index.end()) return it->second;
+        if (stringNum == BLOCK_SIZE * MAX_BLOCK_NUM) {
+            throw std::length_error("MiniMidi: String pool is full!");
+        }
+
+        const uint32_t handle = stringNum.load(std::memory_order_relaxed);
+        std::string *block = blocks[handle >> BLOCK_BITS].load(std::memory_order_relaxed);
+        if (!block) {
+            block = new std::string[BLOCK_SIZE];
+            blocks[handle >> BLOCK_BITS].store(block, std::memory_order_release);
+        }
+        std::string &slot = block[handle & (BLOCK_SIZE - 1)];
+        slot.assign(text);
+        index.emplace(slot, handle);
+        byteNum += text.size();
+        stringNum.store(handle + 1, std::memory_order_release);
+        return handle;
+    };
+
+    [[nodiscard]] std::string_view get(const uint32_t handle) const {
+        if (handle >= stringNum.load(std::memory_order_acquire)) {
+            throw std::out_of_range("MiniMidi: Invalid StringPool handle " + std::to_string(handle) + "!");
+        }
+        return blocks[handle >> BLOCK_BITS].load(std::memory_order_acquire)[handle & (BLOCK_SIZE - 1)];
+    };
+
+    [[nodiscard]] size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stringNum;
+    };
+
+    // bytes of text stored once in the pool
+    [[nodiscard]] size_t byte_num() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return byteNum;
+    };
+};
+
+}
+
+namespace utils {
+
+inline void write_variable_length(container::Bytes& bytes, const uint32_t num) {
+    const uint8_t byteNum = calc_variable_length(num);
+
+    for(auto i = 0; i < byteNum - 1; ++i) {
+        bytes.emplace_back((num >> (7 * (byteNum - i - 1))) | 0x80);
+    }
+    bytes.emplace_back(num & 0x7F);
+};
+
+template<typename Iter>
+void write_iter(container::Bytes& bytes, Iter begin, Iter end) {
+    for(;begin<end;++begin) {
+        bytes.emplace_back(*begin);
+    }
+}
+
+// Absolute time of the next parsed message, which must fit message::Time.
+inline message::Time add_delta_time(const message::Time time, const uint32_t delta) {
+    if (time > message::MAX_TIME - delta) {
+        throw std::ios_base::failure(
+            "MiniMidi: Time overflow! Message time exceeds " + std::to_string(message::MAX_TIME)
+            + " ticks, define MINIMIDI_TIME_TYPE as uint64_t!"
+        );
+    }
+    return time + delta;
+};
+
+// Delta time written before a message, which must fit a variable length quantity.
+inline uint32_t delta_time(const message::Time prevTime, const message::Time curTime) {
+    if (curTime < prevTime) {
+        throw std::invalid_argument("MiniMidi: Messages must be sorted by time!");
+    }
+    if (curTime - prevTime > MAX_VARIABLE_LENGTH) {
+        throw std::invalid_argument(
+            "MiniMidi: Delta time " + std::to_string(curTime - prevTime)
+            + " exceeds the variable length quantity maximum " + std::to_string(MAX_VARIABLE_LENGTH) + "!"
+        );
+    }
+    return static_cast<uint32_t>(curTime - prevTime);
+};
+
+inline container::SmallBytes make_variable_length(uint32_t num) {
+    const uint8_t byteNum = calc_variable_length(num);
+
+    container::SmallBytes result(byteNum);
+    auto* cursor = const_cast<uint8_t*>(result.data());
+    write_variable_length(cursor, num);
+
+    return result;
+};
+
+}
+
+
+namespace message {
+
+inline std::string message_type_to_string(const MessageType &messageType) {
+    switch (messageType) {
+#define MIDI_MESSAGE_TYPE_MEMBER(type, status, length) \
+        case MessageType::type: return #type;
+        MIDI_MESSAGE_TYPE
+#undef MIDI_MESSAGE_TYPE_MEMBER
+    };
+
+    return "Unknown";
+};
+
+inline std::string meta_type_to_string(const MetaType &metaType) {
+    switch (metaType) {
+#define MIDI_META_TYPE_MEMBER(type, status) \
+            case (MetaType::type): return #type;
+        MIDI_META_TYPE
+#undef MIDI_META_TYPE_MEMBER
+    };
+
+    return "Unknown";
+};
+
+typedef struct {
+    uint8_t numerator;
+    uint8_t denominator;
+} TimeSignature;
+
+// major keys then minor keys, from 7 flats to 7 sharps
+const std::string KEYS_NAME[] = {"bC", "bG", "bD", "bA", "bE", "bB", "F", "C", "G",
+                                 "D", "A", "E", "B", "#F", "#C", "ba", "be", "bb",
+                                 "f", "c", "g", "d", "a", "e", "b", "#f", "#c",
+                                 "#g", "#d", "#a"};
+
+class KeySignature {
+public:
+    int8_t key;
+    uint8_t tonality;
+
+    KeySignature() = default;
+    KeySignature(int8_t key, uint8_t tonality): key(key), tonality(tonality) {};
+
+    [[nodiscard]] std::string to_string() const {
+        if (this->key < -7 || this->key > 7 || this->tonality > 1) return "Unknown";
+        return KEYS_NAME[this->key + 7 + this->tonality * 15];
+    };
+
+};
+
+class Message {
+    Time time;
+    uint8_t statusByte;
+    // INTERNED_TEXT: data is {meta type, 4 bytes StringPool handle} instead of the meta value,
+    // never handed out by get_data()
+    uint8_t flags = 0;
+    container::SmallBytes data;
+
+public:
+    static constexpr uint8_t INTERNED_TEXT = 0x01;
+
+    Message() = default;
+    Message(const Time time, const container::SmallBytes &data) {
+        this->time = time;
+        this->statusByte = data[0];
+        this->data.assign(data.begin() + 1, data.end());
+    };
+
+    Message(const Time time, container::SmallBytes &&data) {
+        this->time = time;
+        this->statusByte = data[0];
+        this->data.assign(data.begin() + 1, data.end());
+    };
+
+    Message(const Time time, const uint8_t statusByte, const container::SmallBytes &data) {
+        this->time = time;
+        this->statusByte = statusByte;
+        this->data = data;
+    };
+
+    Message(const Time time, const uint8_t statusByte, container::SmallBytes &&data) {
+        this->time = time;
+        this->statusByte = statusByte;
+        this->data = std::move(data);
+    };
+
+    Message(const Time time, const uint8_t statusByte, const uint8_t *begin, const size_t size):
+        time(time), statusByte(statusByte), data(begin, size) {};
+
+    Message(const Time time, const uint8_t *begin, const size_t size):
+        time(time), statusByte(*begin), data(begin + 1, size - 1) {};
+
+    [[nodiscard]] Time get_time() const { return time; };
+
+    void set_time(const Time time) { this->time = time; };
+
+    [[nodiscard]] uint8_t get_status_byte() const { return statusByte; };
+
+    // Bytes after the status byte. Interned text is not stored as bytes, get_data() throws for it:
+    // use get_meta_bytes() or materialized() for those messages.
+    [[nodiscard]] const container::SmallBytes &get_data() const {
+        if (this->is_interned()) {
+            throw std::logic_error("MiniMidi: Interned text has no data bytes, use get_meta_bytes()!");
+        }
+        return data;
+    };
+
+    [[nodiscard]] MessageType get_type() const { return status_to_message_type(statusByte); };
+
+    [[nodiscard]] std::string get_type_string() const {
+        return message_type_to_string(this->get_type());
+    };
+
+    [[nodiscard]] uint8_t get_channel() const { return statusByte & 0x0F; };
+
+    [[nodiscard]] uint8_t get_pitch() const { return data[0]; };
+
+    [[nodiscard]] uint8_t get_velocity() const { return data[1]; };
+
+    [[nodiscard]] uint8_t get_control_number() const { return data[0]; };
+
+    [[nodiscard]] uint8_t get_control_value() const { return data[1]; };
+
+    [[nodiscard]] uint8_t get_program() const { return data[0]; };
+
+    [[nodiscard]] MetaType get_meta_type() const {
+        return status_to_meta_type(this->data[0]);
+    };
+
+    // Meta type byte, also of meta types unknown to MetaType
+    [[nodiscard]] uint8_t get_meta_type_byte() const { return this->data[0]; };
+
+    [[nodiscard]] std::string get_meta_type_string() const {
+        return meta_type_to_string(this->get_meta_type());
+    }
+
+    // Data bytes from offset on, after a variable length prefix, clamped to the data size.
+    [[nodiscard]] container::ByteView get_prefixed_bytes(const size_t offset) const {
+        const uint8_t *cursor = this->data.data() + std::min(offset, this->data.size());
+        const uint8_t *end = this->data.data() + this->data.size();
+        uint32_t length = 0;
+        for (auto i = 0; i < 4 && cursor < end; ++i) {
+            const uint8_t byte = *cursor++;
+            length = (length << 7) | (byte & 0x7F);
+            if (!(byte & 0x80)) break;
+        }
+        return {cursor, std::min<size_t>(length, end - cursor)};
+    };
+
+    [[nodiscard]] bool is_interned() const { return flags & INTERNED_TEXT; };
+
+    // StringPool handle of an interned text meta message, equal handles mean equal text
+    [[nodiscard]] uint32_t get_text_handle() const {
+        return static_cast<uint32_t>(utils::read_msb_bytes(this->data.data() + 1, 4));
+    };
+
+    // Meta value without copy, valid as long as the message is not modified
+    [[nodiscard]] container::ByteView get_meta_bytes() const {
+        if (this->is_interned()) {
+            const std::string_view text = container::StringPool::global().get(this->get_text_handle());
+            return {reinterpret_cast<const uint8_t *>(text.data()), text.size()};
+        }
+        return this->get_prefixed_bytes(1);
+    };
+
+    // Meta value of text meta messages (Text, TrackName, Lyric, ...) without copy
+    [[nodiscard]] std::string_view get_meta_text() const {
+        const container::ByteView bytes = this->get_meta_bytes();
+        return {reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+    };
+
+    // SysEx body after the length prefix, including the trailing 0xF7, without copy
+    [[nodiscard]] container::ByteView get_sysex_bytes() const {
+        return this->get_prefixed_bytes(0);
+    };
+
+    [[nodiscard]] container::SmallBytes get_meta_value() const {
+        const container::ByteView bytes = this->get_meta_bytes();
+        return {bytes.begin(), bytes.end()};
+    };
+
+    [[nodiscard]] uint32_t get_tempo() const {
+        return utils::read_msb_bytes(const_cast<uint8_t *>(this->data.data()) + 2, 3);
+    };
+
+    [[nodiscard]] message::TimeSignature get_time_signature() const {
+        // Clang-Tidy: Avoid repeating the return type from the declaration;
+        // use a braced initializer list instead
+        return {data[2], static_cast<uint8_t>(1 << data[3])};
+    };
+
+    [[nodiscard]] message::KeySignature get_key_signature() const {
+        // Clang-Tidy: Avoid repeating the return type from the declaration;
+        // use a braced initializer list instead
+        return {static_cast<int8_t>(data[2]), data[3]};
+    }
+
+    [[nodiscard]] int16_t get_pitch_bend() const {
+        return static_cast<int16_t>(data[0] | (data[1] << 7) + MIN_PITCHBEND);
+    };
+
+    [[nodiscard]] uint16_t get_song_position_pointer() const {
+        return static_cast<uint16_t>(data[0] | (data[1] << 7));
+    };
+
+    [[nodiscard]] uint8_t get_frame_type() const {
+        return data[0] >> 4;
+    };
+
+    [[nodiscard]] uint8_t get_frame_value() const {
+        return data[0] & 0x0F;
+    };
+
+    static Message NoteOn(Time time, uint8_t channel, uint8_t pitch, uint8_t velocity) {
+        return { time,
+            static_cast<uint8_t>(message_status<MessageType::NoteOn>() | channel),
+            container::SmallBytes{pitch, velocity}};
+    };
+
+    static Message NoteOff(Time time, uint8_t channel, uint8_t pitch, uint8_t velocity) {
+        return { time,
+            static_cast<uint8_t>(message_status<MessageType::NoteOff>() | channel),
+            container::SmallBytes{pitch, velocity}};
+    };
+
+    static Message ControlChange(Time time, uint8_t channel, uint8_t controlNumber, uint8_t controlValue) {
+        return { time,
+            static_cast<uint8_t>(message_status<MessageType::ControlChange>() | channel),
+            container::SmallBytes{controlNumber, controlValue}};
+    };
+
+    static Message ProgramChange(Time time, uint8_t channel, uint8_t program) {
+        return { time,
+            static_cast<uint8_t>(message_status<MessageType::ProgramChange>() | channel),
+            container::SmallBytes{program}};
+    };
+
+    static Message SysEx(Time time, const container::SmallBytes &data) {
+        // the length counts the trailing SysExEnd
+        const size_t lenBytesNum = utils::calc_variable_length(data.size() + 1);
+        container::SmallBytes buffer(data.size() + lenBytesNum + 1);
+
+        // Write length bytes
+        auto *cursor = const_cast<uint8_t*>(buffer.data());
+        utils::write_variable_length(cursor, data.size() + 1);
+
+        // Write data
+        std::copy(data.begin(), data.end(), cursor);
+
+        // Write SysExEnd
+        buffer[buffer.size() - 1] = message_status<MessageType::SysExEnd>(); // 0xF7;
+
+        return { time,
+            message_status<MessageType::SysExStart>(), // 0xF0
+            std::move(buffer)};
+    };
+
+    static Message SongPositionPointer(Time time, uint16_t position) {
+        // the type of position is uint14_t
+        return { time,
+            message_status<MessageType::SongPositionPointer>(),
+            container::SmallBytes{
+                static_cast<uint8_t>(position & 0x7F),
+                static_cast<uint8_t>(position >> 7)
+            }
+        };
+    };
+
+    static Message PitchBend(Time time, uint8_t channel, int16_t value ) {
+        value -= MIN_PITCHBEND;
+        return { time,
+            static_cast<uint8_t>(message_status<MessageType::PitchBend>() | channel),
+            container::SmallBytes{
+                static_cast<uint8_t>(value & 0x7F),
+                static_cast<uint8_t>(value >> 7)
+           }
+        };
+    };
+
+    static Message QuarterFrame(Time time, uint8_t type, uint8_t value) {
+        return { time,
+            static_cast<uint8_t>(message_status<MessageType::QuarterFrame>()),
+            container::SmallBytes{
+                static_cast<uint8_t>((type << 4) | value )
+            }
+        };
+    };
+
+    static Message Meta(Time time, MetaType metaType, const container::SmallBytes &metaValue) {
+        const size_t lenBytesNum = utils::calc_variable_length(metaValue.size());
+        container::SmallBytes buffer(metaValue.size() + lenBytesNum + 1);
+
+        // Write meta type
+        buffer[0] = static_cast<uint8_t>(metaType);
+
+        // Write meta length
+        uint8_t* cursor = const_cast<uint8_t*>(buffer.data()) + 1;
+        utils::write_variable_length(cursor, metaValue.size());
+
+        // Write meta value
+        std::copy(metaValue.begin(), metaValue.end(), cursor);
+
+        return {time,
+            message_status<MessageType::Meta>(), //0xFF;
+            std::move(buffer)};
+    };
+
+    static Message Meta(Time time, MetaType metaType, const std::string &metaValue) {
+        const size_t lenBytesNum = utils::calc_variable_length(metaValue.size());
+        container::SmallBytes buffer(metaValue.size() + lenBytesNum + 1);
+
+        // Write meta type
+        buffer[0] = static_cast<uint8_t>(metaType);
+
+        // Write meta length
+        uint8_t* cursor = const_cast<uint8_t*>(buffer.data()) + 1;
+        utils::write_variable_length(cursor, metaValue.size());
+
+        // Write meta value
+        std::copy(metaValue.begin(), metaValue.end(), cursor);
+
+        return {time,
+            message_status<MessageType::Meta>(), //0xFF;
+            std::move(buffer)};
+    };
+
+    // Text meta message storing a StringPool handle instead of the text
+    static Message InternedText(const Time time, const MetaType metaType, const std::string_view text) {
+        const uint32_t handle = container::StringPool::global().intern(text);
+        Message message(time,
+            message_status<MessageType::Meta>(), //0xFF,
+            container::SmallBytes{
+                static_cast<uint8_t>(metaType),
+                static_cast<uint8_t>(handle >> 24),
+                static_cast<uint8_t>((handle >> 16) & 0xFF),
+                static_cast<uint8_t>((handle >> 8) & 0xFF),
+                static_cast<uint8_t>(handle & 0xFF)
+            }
+        );
+        message.flags = INTERNED_TEXT;
+        return message;
+    };
+
+    // Copy of the message with interned text replaced by the text itself
+    [[nodiscard]] Message materialized() const {
+        if (!this->is_interned()) return *this;
+        return Meta(this->time, this->get_meta_type(), std::string(this->get_meta_text()));
+    };
+
+    static Message Text(const Time time, const std::string &text) {
+        return Meta(time, MetaType::Text, text);
+    };
+
+    static Message TrackName(const Time time, const std::string &name) {
+        return Meta(time, MetaType::TrackName, name);
+    };
+
+    static Message InstrumentName(const Time time, const std::string &name) {
+        return Meta(time, MetaType::InstrumentName, name);
+    };
+
+    static Message Lyric(const Time time, const std::string &lyric) {
+        return Meta(time, MetaType::Lyric, lyric);
+    };
+
+    static Message Marker(const Time time, const std::string &marker) {
+        return Meta(time, MetaType::Marker, marker);
+    };
+
+    static Message CuePoint(const Time time, const std::string &cuePoint) {
+        return Meta(time, MetaType::CuePoint, cuePoint);
+    };
+
+    static Message MIDIChannelPrefix(const Time time, const uint8_t channel) {
+        return {time,
+            message_status<MessageType::Meta>(), //0xFF,
+            container::SmallBytes{
+                static_cast<uint8_t>(message::MetaType::MIDIChannelPrefix), //0x20,
+                static_cast<uint8_t>(1),
+                channel
+            }
+        };
+    };
+
+    static Message EndOfTrack(const Time time) {
+        return {time,
+            message_status<MessageType::Meta>(), //0xFF,
+            container::SmallBytes{
+                static_cast<uint8_t>(message::MetaType::EndOfTrack), //0x2F,
+                static_cast<uint8_t>(0)
+            }
+        };
+    };
+
+    static Message SetTempo(const Time time, const uint32_t tempo) {
+        return {time,
+            message_status<MessageType::Meta>(), //0xFF,
+            container::SmallBytes{
+                static_cast<uint8_t>(message::MetaType::SetTempo), //0x51,
+                static_cast<uint8_t>(3),
+                static_cast<uint8_t>((tempo >> 16) & 0xFF),
+                static_cast<uint8_t>((tempo >> 8) & 0xFF),
+                static_cast<uint8_t>(tempo & 0xFF)
+            }
+        };
+    };
+
+    static Message SMPTEOffset(const Time time, const uint8_t hour, const uint8_t minute,const uint8_t second, const uint8_t frame, const uint8_t subframe) {
+        return {time,
+            message_status<MessageType::Meta>(), //0xFF,
+            container::SmallBytes{
+                static_cast<uint8_t>(message::MetaType::SMPTEOffset), //0x54,
+                static_cast<uint8_t>(5),
+                hour,
+                minute,
+                second,
+                frame,
+                subframe
+            }
+        };
+    };
+
+    static Message TimeSignature(const Time time, const uint8_t numerator, const uint8_t denominator) {
+        return {time,
+            message_status<MessageType::Meta>(), //0xFF,
+            container::SmallBytes{
+                static_cast<uint8_t>(message::MetaType::TimeSignature), //0x58,
+                static_cast<uint8_t>(4),
+                numerator,
+                static_cast<uint8_t>(std::log2(denominator)),
+                static_cast<uint8_t>(0x18),
+                static_cast<uint8_t>(0x08)
+            }
+        };
+    };
+
+    static Message KeySignature(const Time time, const int8_t key, const uint8_t tonality) {
+        return {time,
+            message_status<MessageType::Meta>(), //0xFF,
+            container::SmallBytes{
+                static_cast<uint8_t>(message::MetaType::KeySignature), //0x59,
+                static_cast<uint8_t>(2),
+                static_cast<uint8_t>(key),
+                tonality
+            }
+        };
+    };
+};
+
+typedef std::vector<Message> Messages;
+
+// Typed events: the fields of a message decoded once into a small struct per message type,
+// and per meta type for meta messages. Pointers and string views refer to the data of the
+// decoded Message, which must outlive the event.
+namespace event {
+
+class NoteOff {
+public:
+    Time time;
+    uint8_t channel, pitch, velocity;
+
+    explicit NoteOff(const Message &message):
+        time(message.get_time()), channel(message.get_channel()),
+        pitch(message.get_pitch()), velocity(message.get_velocity()) {};
+};
+
+class NoteOn {
+public:
+    Time time;
+    uint8_t channel, pitch, velocity;
+
+    explicit NoteOn(const Message &message):
+        time(message.get_time()), channel(message.get_channel()),
+        pitch(message.get_pitch()), velocity(message.get_velocity()) {};
+};
+
+class PolyphonicAfterTouch {
+public:
+    Time time;
+    uint8_t channel, pitch, pressure;
+
+    explicit PolyphonicAfterTouch(const Message &message):
+        time(message.get_time()), channel(message.get_channel()),
+        pitch(message.get_data()[0]), pressure(message.get_data()[1]) {};
+};
+
+class ControlChange {
+public:
+    Time time;
+    uint8_t channel, controlNumber, controlValue;
+
+    explicit ControlChange(const Message &message):
+        time(message.get_time()), channel(message.get_channel()),
+        controlNumber(message.get_control_number()), controlValue(message.get_control_value()) {};
+};
+
+class ProgramChange {
+public:
+    Time time;
+    uint8_t channel, program;
+
+    explicit ProgramChange(const Message &message):
+        time(message.get_time()), channel(message.get_channel()), program(message.get_program()) {};
+};
+
+class ChannelAfterTouch {
+public:
+    Time time;
+    uint8_t channel, pressure;
+
+    explicit ChannelAfterTouch(const Message &message):
+        time(message.get_time()), channel(message.get_channel()), pressure(message.get_data()[0]) {};
+};
+
+class PitchBend {
+public:
+    Time time;
+    uint8_t channel;
+    int16_t value;
+
+    explicit PitchBend(const Message &message):
+        time(message.get_time()), channel(message.get_channel()), value(message.get_pitch_bend()) {};
+};
+
+// body after the variable length prefix, including the trailing 0xF7
+class SysExStart {
+public:
+    Time time;
+    const uint8_t *data;
+    size_t size;
+
+    explicit SysExStart(const Message &message): time(message.get_time()) {
+        const container::ByteView body = message.get_sysex_bytes();
+        data = body.data();
+        size = body.size();
+    };
+};
+
+class QuarterFrame {
+public:
+    Time time;
+    uint8_t frameType, frameValue;
+
+    explicit QuarterFrame(const Message &message):
+        time(message.get_time()), frameType(message.get_frame_type()), frameValue(message.get_frame_value()) {};
+};
+
+class SongPositionPointer {
+public:
+    Time time;
+    uint16_t position;
+
+    explicit SongPositionPointer(const Message &message):
+        time(message.get_time()), position(message.get_song_position_pointer()) {};
+};
+
+class SongSelect {
+public:
+    Time time;
+    uint8_t song;
+
+    explicit SongSelect(const Message &message): time(message.get_time()), song(message.get_data()[0]) {};
+};
+
+// messages without data bytes
+#define MIDI_EMPTY_EVENT(type)                                          \
+class type {                                                            \
+public:                                                                 \
+    Time time;                                                          \
+                                                                        \
+    explicit type(const Message &message): time(message.get_time()) {}; \
+};
+
+MIDI_EMPTY_EVENT(TuneRequest)
+MIDI_EMPTY_EVENT(SysExEnd)
+MIDI_EMPTY_EVENT(TimingClock)
+MIDI_EMPTY_EVENT(StartSequence)
+MIDI_EMPTY_EVENT(ContinueSequence)
+MIDI_EMPTY_EVENT(StopSequence)
+MIDI_EMPTY_EVENT(ActiveSensing)
+
+// undefined status byte
+class Unknown {
+public:
+    Time time;
+    uint8_t statusByte;
+    const uint8_t *data;
+    size_t size;
+
+    explicit Unknown(const Message &message):
+        time(message.get_time()), statusByte(message.get_status_byte()),
+        data(message.get_data().data()), size(message.get_data().size()) {};
+};
+
+// Meta messages are dispatched on their meta type, see namespace meta.
+class Meta {
+public:
+    Time time;
+    uint8_t metaType;
+    const uint8_t *data;
+    size_t size;
+
+    explicit Meta(const Message &message): time(message.get_time()), metaType(message.get_meta_type_byte()) {
+        const container::ByteView value = message.get_meta_bytes();
+        data = value.data();
+        size = value.size();
+    };
+
+    // value byte i, 0 if the value is too short
+    [[nodiscard]] uint8_t byte(const size_t i) const { return i < size ? data[i] : 0; };
+};
+
+namespace meta {
+
+class SequenceNumber {
+public:
+    Time time;
+    uint16_t number;
+
+    explicit SequenceNumber(const Message &message) {
+        const Meta meta(message);
+        time = meta.time;
+        number = static_cast<uint16_t>((meta.byte(0) << 8) | meta.byte(1));
+    };
+};
+
+// text meta messages
+#define MIDI_TEXT_EVENT(type)                                                   \
+class type {                                                                    \
+public:                                                                         \
+    Time time;                                                                  \
+    std::string_view text;                                                      \
+                                                                                \
+    explicit type(const Message &message):                                      \
+        time(message.get_time()), text(message.get_meta_text()) {};             \
+};
+
+MIDI_TEXT_EVENT(Text)
+MIDI_TEXT_EVENT(CopyrightNote)
+MIDI_TEXT_EVENT(TrackName)
+MIDI_TEXT_EVENT(InstrumentName)
+MIDI_TEXT_EVENT(Lyric)
+MIDI_TEXT_EVENT(Marker)
+MIDI_TEXT_EVENT(CuePoint)
+
+#undef MIDI_TEXT_EVENT
+
+class MIDIChannelPrefix {
+public:
+    Time time;
+    uint8_t channel;
+
+    explicit MIDIChannelPrefix(const Message &message) {
+        const Meta meta(message);
+        time = meta.time;
+        channel = meta.byte(0);
+    };
+};
+
+MIDI_EMPTY_EVENT(EndOfTrack)
+
+class SetTempo {
+public:
+    Time time;
+    // microseconds per quarter note
+    uint32_t tempo;
+
+    explicit SetTempo(const Message &message) {
+        const Meta meta(message);
+        time = meta.time;
+        tempo = (meta.byte(0) << 16) | (meta.byte(1) << 8) | meta.byte(2);
+    };
+};
+
+class SMPTEOffset {
+public:
+    Time time;
+    uint8_t hour, minute, second, frame, subframe;
+
+    explicit SMPTEOffset(const Message &message) {
+        const Meta meta(message);
+        time = meta.time;
+        hour = meta.byte(0);
+        minute = meta.byte(1);
+        second = meta.byte(2);
+        frame = meta.byte(3);
+        subframe = meta.byte(4);
+    };
+};
+
+class TimeSignature {
+public:
+    Time time;
+    uint8_t numerator, denominator, clocksPerClick, notated32nds;
+
+    explicit TimeSignature(const Message &message) {
+        const Meta meta(message);
+        time = meta.time;
+        numerator = meta.byte(0);
+        denominator = static_cast<uint8_t>(1 << meta.byte(1));
+        clocksPerClick = meta.byte(2);
+        notated32nds = meta.byte(3);
+    };
+};
+
+class KeySignature {
+public:
+    Time time;
+    int8_t key;
+    uint8_t tonality;
+
+    explicit KeySignature(const Message &message) {
+        const Meta meta(message);
+        time = meta.time;
+        key = static_cast<int8_t>(meta.byte(0));
+        tonality = meta.byte(1);
+    };
+};
+
+class SequencerSpecificMeta {
+public:
+    Time time;
+    const uint8_t *data;
+    size_t size;
+
+    explicit SequencerSpecificMeta(const Message &message) {
+        const Meta meta(message);
+        time = meta.time;
+        data = meta.data;
+        size = meta.size;
+    };
+};
+
+// undefined meta type
+class Unknown: public Meta {
+public:
+    explicit Unknown(const Message &message): Meta(message) {};
+};
+
+}
+
+#undef MIDI_EMPTY_EVENT
+
+// Combine lambdas into one visitor, e.g. Overloaded{[](const NoteOn &e) {...}, [](const auto &) {}}
+template<typename... Funcs>
+class Overloaded: public Funcs... {
+public:
+    using Funcs::operator()...;
+};
+
+template<typename... Funcs>
+Overloaded(Funcs...) -> Overloaded<Funcs...>;
+
+template<typename Visitor>
+decltype(auto) visit_meta(const Message &message, Visitor &&visitor) {
+    switch (message.get_meta_type()) {
+#define MIDI_META_TYPE_MEMBER(type, status) \
+        case MetaType::type: return visitor(meta::type(message));
+        MIDI_META_TYPE
+#undef MIDI_META_TYPE_MEMBER
+    }
+    return visitor(meta::Unknown(message));
+};
+
+}
+
+// Decode message into its typed event and call visitor with it. Meta messages are passed
+// as the event of their meta type (event::meta::SetTempo, ...). All overloads of the
+// visitor must return the same type.
+template<typename Visitor>
+decltype(auto) visit(const Message &message, Visitor &&visitor) {
+    switch (message.get_type()) {
+#define MIDI_MESSAGE_TYPE_MEMBER(type, status, length) \
+        case MessageType::type: {                                                   \
+            if constexpr (std::is_same_v<event::type, event::Meta>)                 \
+                return event::visit_meta(message, std::forward<Visitor>(visitor));  \
+            else                                                                    \
+                return visitor(event::type(message));                               \
+        };
+        MIDI_MESSAGE_TYPE
+#undef MIDI_MESSAGE_TYPE_MEMBER
+    }
+    return visitor(event::Unknown(message));
+};
+
+template<typename Visitor>
+void visit(const Messages &messages, Visitor &&visitor) {
+    for (const auto &msg: messages) visit(msg, visitor);
+};
+
+#undef MIDI_MESSAGE_TYPE
+#undef MIDI_META_TYPE
+
+}
+
+
+namespace track {
+
+const std::string MTRK("MTrk");
+
+// Summary of a track, computed by the parser in the same decode loop.
+// firstTick > lastTick for a track without messages, minPitch > maxPitch for a track without notes.
+class TrackSummary {
+public:
+    message::Time firstTick = message::MAX_TIME;
+    message::Time lastTick = 0;
+    // bit i for channel i
+    uint16_t channels = 0;
+    uint32_t noteNum = 0;
+    uint8_t minPitch = 127;
+    uint8_t maxPitch = 0;
+    bool hasTempo = false;
+
+    void update(const message::Message &msg) {
+        const message::Time time = msg.get_time();
+        firstTick = std::min(firstTick, time);
+        lastTick = std::max(lastTick, time);
+
+        const uint8_t status = msg.get_status_byte();
+        if (status < 0xF0) {
+            channels |= static_cast<uint16_t>(1 << (status & 0x0F));
+            // Note on with velocity > 0
+            if ((status & 0xF0) == 0x90 && msg.get_velocity()) {
+                ++noteNum;
+                minPitch = std::min(minPitch, msg.get_pitch());
+                maxPitch = std::max(maxPitch, msg.get_pitch());
+            }
+        } else if (status == 0xFF && msg.get_meta_type() == message::MetaType::SetTempo) {
+            hasTempo = true;
+        }
+    };
+
+    [[nodiscard]] bool has_channel(const uint8_t channel) const {
+        return (channels >> channel) & 1;
+    };
+};
+
+class Track {
+public:
+    message::Messages messages;
+    // Filled by the parser, std::nullopt for constructed tracks.
+    // Not updated when messages are modified, call compute_summary() after editing.
+    std::optional<TrackSummary> summary;
+    Track() = default;
+
+    // explicit Track(const container::ByteSpan data) {
+    // internText: store text meta messages as handles of container::StringPool::global()
+    Track(const uint8_t *cursor, const size_t size, const bool internText = false) {
+        messages.reserve(size / 3 + 100);
+        const uint8_t *bufferEnd = cursor + size;
+
+        message::Time tickOffset = 0;
+        uint8_t prevStatusCode = 0x00;
+        size_t prevEventLen = 0;
+        TrackSummary trackSummary;
+
+        while (cursor < bufferEnd) {
+            tickOffset = utils::add_delta_time(tickOffset, utils::read_variable_length(cursor));
+            // Running status
+            if (const uint8_t curStatusCode = *cursor; curStatusCode < 0x80) {
+                if (!prevEventLen) {
+                    throw std::ios_base::failure(
+                        "MiniMidi: Unexpected running status! Get status code: "
+                        + std::to_string(curStatusCode)
+                        + " but previous event length is 0!"
+                    );
+                }
+                if (cursor + prevEventLen - 1 > bufferEnd) {
+                    throw std::ios_base::failure(
+                        "MiniMidi: Unexpected EOF in running status! Cursor would be "
+                        + std::to_string(cursor + prevEventLen - 1 - bufferEnd)
+                        + " bytes beyond the end of buffer with previous event length "
+                        + std::to_string(prevEventLen) + "!"
+                    );
+                }
+                messages.emplace_back(tickOffset, prevStatusCode, cursor, prevEventLen - 1);
+                trackSummary.update(messages.back());
+                cursor += prevEventLen - 1;
+            }
+            // Meta message
+            else if (curStatusCode == 0xFF) {
+                // Meta message does not affect running status
+                // prevStatusCode = curStatusCode;
+                const uint8_t *prevBuffer = cursor;
+
+                // Skip status byte and meta type byte
+                cursor += 2;
+                auto eventLen = utils::read_variable_length(cursor) + (cursor - prevBuffer);
+
+                if (prevBuffer + eventLen > bufferEnd) {
+                    throw std::ios_base::failure(
+                        "MiniMidi: Unexpected EOF in Meta Event! Cursor would be "
+                        + std::to_string(cursor + eventLen - bufferEnd)
+                        + " bytes beyond the end of buffer with previous event length "
+                        + std::to_string(eventLen) + "!"
+                    );
+                }
+                if (const auto metaType = message::status_to_meta_type(prevBuffer[1]);
+                    internText && message::is_text_meta(metaType)) {
+                    messages.emplace_back(message::Message::InternedText(tickOffset, metaType,
+                        {reinterpret_cast<const char *>(cursor), static_cast<size_t>(eventLen - (cursor - prevBuffer))}));
+                } else {
+                    messages.emplace_back(tickOffset, prevBuffer, eventLen);
+                }
+                trackSummary.update(messages.back());
+
+                if (messages.back().get_meta_type() == message::MetaType::EndOfTrack)
+                    break;
+
+                cursor = prevBuffer + eventLen;
+            }
+            // SysEx message, or SysEx escape (0xF7), both prefixed with their length
+            else if (curStatusCode == 0xF0 || curStatusCode == 0xF7) {
+                const uint8_t *prevBuffer = cursor;
+
+                // Skip status byte
+                cursor += 1;
+                const auto eventLen = utils::read_variable_length(cursor) + (cursor - prevBuffer);
+
+                if (prevBuffer + eventLen > bufferEnd) {
+                    throw std::ios_base::failure(
+                        "MiniMidi: Unexpected EOF in SysEx Event! Cursor would be "
+                        + std::to_string(prevBuffer + eventLen - bufferEnd)
+                        + " bytes beyond the end of buffer with previous event length "
+                        + std::to_string(eventLen) + "!"
+                    );
+                }
+                messages.emplace_back(tickOffset, prevBuffer, eventLen);
+                trackSummary.update(messages.back());
+                cursor = prevBuffer + eventLen;
+                // SysEx cancels running status
+                prevStatusCode = 0x00;
+                prevEventLen = 0;
+            }
+            // Channel message or system common message
+            else {
+                prevStatusCode = curStatusCode;
+                prevEventLen = message::status_to_length(curStatusCode);
+                if (!prevEventLen) {
+                    throw std::ios_base::failure(
+                        "MiniMidi: Undefined status code: " + std::to_string(curStatusCode) + "!"
+                    );
+                }
+
+                if (cursor + prevEventLen > bufferEnd) {
+                    throw std::ios_base::failure(
+                        "MiniMidi: Unexpected EOF in MIDI Event! Cursor would be "
+                        + std::to_string(cursor + prevEventLen - bufferEnd)
+                        + " bytes beyond the end of buffer with previous event length "
+                        + std::to_string(prevEventLen) + "!"
+                    );
+                }
+                messages.emplace_back(tickOffset, cursor, prevEventLen);
+                trackSummary.update(messages.back());
+                cursor += prevEventLen;
+            }
+
+            if (cursor > bufferEnd) {
+                throw std::ios_base::failure(
+                    "MiniMidi: Unexpected EOF in track! Cursor is "
+                    + std::to_string(cursor - bufferEnd)
+                    + " bytes beyond the end of buffer!"
+                );
+            }
+        }
+        this->summary = trackSummary;
+    };
+
+    explicit Track(message::Messages &&message) {
+        this->messages = std::vector(std::move(message));
+    };
+
+    message::Message &message(const uint32_t index) {
+        return this->messages[index];
+    };
+
+    [[nodiscard]] const message::Message &message(const uint32_t index) const {
+        return this->messages[index];
+    };
+
+    [[nodiscard]] size_t message_num() const {
+        return this->messages.size();
+    };
+
+    const TrackSummary &compute_summary() {
+        TrackSummary trackSummary;
+        for (const auto &msg: this->messages) trackSummary.update(msg);
+        this->summary = trackSummary;
+        return *this->summary;
+    };
+
+    // Remove messages matching pred in place, keeping the order. Return the number of removed messages.
+    template<typename Pred>
+    size_t erase_if(Pred &&pred) {
+        const auto newEnd = std::remove_if(this->messages.begin(), this->messages.end(), std::forward<Pred>(pred));
+        const size_t removed = this->messages.end() - newEnd;
+        this->messages.erase(newEnd, this->messages.end());
+        return removed;
+    }
+
+    [[nodiscard]] container::Bytes to_bytes() const {
+        // Prepare EOT
+        static const message::Message _eot = message::Message::EndOfTrack(0);
+
+        // (time, index)
+        typedef std::pair<message::Time, size_t> SortHelper;
+        std::vector<SortHelper> msgHeaders;
+        msgHeaders.reserve(this->messages.size());
+        size_t dataLen = 0;
+
+        for (int i = 0; i < this->messages.size(); ++i) {
+            if(this->messages[i].get_type() != message::MessageType::Meta ||
+                this->messages[i].get_meta_type() != message::MetaType::EndOfTrack) {
+                msgHeaders.emplace_back(this->messages[i].get_time(), i);
+                // interned text: meta type, length and text
+                dataLen += this->messages[i].is_interned()
+                    ? 5 + this->messages[i].get_meta_bytes().size()
+                    : this->messages[i].get_data().size();
+            }
+        }
+
+        std::sort(msgHeaders.begin(),
+            msgHeaders.end());
+
+        container::Bytes trackBytes(dataLen + 5 * msgHeaders.size() + 8);
+
+        uint8_t* cursor = trackBytes.data();
+        message::Time prevTime = 0;
+        uint8_t prevStatus = 0x00;
+
+        // Write track chunk header
+        std::copy(MTRK.begin(), MTRK.end(), cursor);
+        cursor += 8;
+        for(const auto & [tick, idx] : msgHeaders) {
+            const message::Message &thisMsg = this->messages[idx];
+            const message::Time curTime = thisMsg.get_time();
+            const uint8_t curStatus = thisMsg.get_status_byte();
+
+            utils::write_variable_length(cursor, utils::delta_time(prevTime, curTime));
+            prevTime = curTime;
+
+            // Not running status, write status byte
+            if(curStatus == 0xFF ||
+                curStatus == 0xF0 ||
+                curStatus == 0xF7 ||
+                curStatus != prevStatus) {
+                *cursor = curStatus;
+                ++cursor;
+            }
+            // Write data bytes
+            if (thisMsg.is_interned()) {
+                const container::ByteView text = thisMsg.get_meta_bytes();
+                *cursor = thisMsg.get_meta_type_byte();
+                ++cursor;
+                utils::write_variable_length(cursor, text.size());
+                std::copy(text.begin(), text.end(), cursor);
+                cursor += text.size();
+            } else {
+                std::copy(thisMsg.get_data().begin(), thisMsg.get_data().end(), cursor);
+                cursor += thisMsg.get_data().size();
+            }
+
+            prevStatus = curStatus;
+        }
+        // Write EOT
+        utils::write_variable_length(cursor, 1);
+        *cursor = _eot.get_status_byte();
+        ++cursor;
+        std::copy(_eot.get_data().begin(), _eot.get_data().end(), cursor);
+        cursor += _eot.get_data().size();
+
+        // Write track chunk length
+        utils::write_msb_bytes(trackBytes.data() + 4, cursor - trackBytes.data() - 8, 4);
+
+        trackBytes.resize(cursor - trackBytes.data());
+
+        return trackBytes;
+    };
+
+};
+
+typedef std::vector<Track> Tracks;
+
+}
+
+
+namespace file {
+
+const std::string MTHD("MThd");
+
+#define MIDI_FORMAT                       \
+    MIDI_FORMAT_MEMBER(SingleTrack, 0)    \
+    MIDI_FORMAT_MEMBER(MultiTrack, 1)     \
+    MIDI_FORMAT_MEMBER(MultiSong, 2)      \
+
+enum class MidiFormat {
+#define MIDI_FORMAT_MEMBER(type, status) type = status,
+    MIDI_FORMAT
+#undef MIDI_FORMAT_MEMBER
+};
+
+inline const std::string &format_to_string(const MidiFormat &format) {
+    static const std::string formats[] = {
+#define MIDI_FORMAT_MEMBER(type, status) #type,
+        MIDI_FORMAT
+#undef MIDI_FORMAT_MEMBER
+    };
+
+    return formats[static_cast<int>(format)];
+};
+
+inline MidiFormat read_midiformat(const uint16_t data) {
+    switch (data) {
+#define MIDI_FORMAT_MEMBER(type, status) case status: return MidiFormat::type;
+        MIDI_FORMAT
+#undef MIDI_FORMAT_MEMBER
+        default: throw std::ios_base::failure(
+            "MiniMidi: Invaild midi format ("
+            + std::to_string(data) + ")!"
+            + "1 for single track, 2 for multi track, 3 for multi song."
+        );
+    }
+};
+
+class MidiFile {
+public:
+    MidiFormat format;
+    uint16_t divisionType: 1;
+    union {
+        struct {
+            uint16_t ticksPerQuarter: 15;
+        };
+        struct {
+            uint16_t negativeSmpte: 7;
+            uint16_t ticksPerFrame: 8;
+        };
+    };
+    track::Tracks tracks;
+
+    // MidiFile() = default;
+
+    // internText: see track::Track
+    explicit MidiFile(const uint8_t* const data, const size_t size, const bool internText = false) {
+        if (size < 4) {
+            throw std::ios_base::failure("MiniMidi: Invaild midi file! File size is less than 4!");
+        }
+        const uint8_t* cursor = data;
+        const uint8_t* bufferEnd = cursor + size;
+
+        if (std::string(reinterpret_cast<const char*>(cursor), 4) != MTHD) {
+            throw std::ios_base::failure("MiniMidi: Invaild midi file! File header is not MThd!");
+        }
+        if (const auto chunkLen = utils::read_msb_bytes(cursor + 4, 4); chunkLen != 6) {
+            throw std::ios_base::failure(
+                "MiniMidi: Invaild midi file! The first chunk length is not 6, but "
+                + std::to_string(chunkLen) + "!"
+            );
+        }
+        this->format = read_midiformat(utils::read_msb_bytes(cursor + 8, 2));
+        const uint16_t trackNum = utils::read_msb_bytes(cursor + 10, 2);
+        this->divisionType = ((*(cursor + 12)) & 0x80) >> 7;
+        this->ticksPerQuarter = (((*(cursor + 12)) & 0x7F) << 8) + (*(cursor + 13));
+
+        cursor += 14;
+        tracks.reserve(trackNum);
+        for (int i = 0; i < trackNum; ++i) {
+            // Skip unknown chunk
+            while(std::string(reinterpret_cast<const char*>(cursor), 4) != track::MTRK) {
+                const size_t chunkLen = utils::read_msb_bytes(cursor + 4, 4);
+
+                if(cursor + chunkLen + 8 > bufferEnd) {
+                    throw std::ios_base::failure(
+                        "MiniMidi: Unexpected EOF in file! Cursor is "
+                        + std::to_string(cursor + chunkLen + 8 - bufferEnd)
+                        + " bytes beyond the end of buffer with chunk length "
+                        + std::to_string(chunkLen) + "!"
+                    );
+                }
+                cursor += (8 + chunkLen);
+            }
+
+            const size_t chunkLen = utils::read_msb_bytes(cursor + 4, 4);
+
+            if (cursor + chunkLen + 8 > bufferEnd) {
+                throw std::ios_base::failure(
+                    "MiniMidi: Unexpected EOF in file! Cursor is "
+                    + std::to_string(cursor + chunkLen + 8 - bufferEnd)
+                    + " bytes beyond the end of buffer with chunk length "
+                    + std::to_string(chunkLen) + "!"
+                );
+            }
+
+            this->tracks.emplace_back(cursor + 8, chunkLen, internText);
+            cursor += (8 + chunkLen);
+        }
+    };
+
+    explicit MidiFile(const container::Bytes &data, const bool internText = false) :
+        MidiFile(data.data(), data.size(), internText) {};
+
+    explicit MidiFile(MidiFormat format=MidiFormat::MultiTrack,
+                    uint8_t divisionType=0,
+                    uint16_t ticksPerQuarter=960) {
+        this->format = format;
+        this->divisionType = divisionType;
+        this->ticksPerQuarter = ticksPerQuarter;
+    };
+
+    explicit MidiFile(track::Tracks &&tracks,
+                    MidiFormat format=MidiFormat::MultiTrack,
+                    uint8_t divisionType=0,
+                    uint16_t ticksPerQuarter=960) {
+        this->tracks = tracks;
+        this->format = format;
+        this->divisionType = divisionType;
+        this->ticksPerQuarter = ticksPerQuarter;
+    };
+
+    explicit MidiFile(const track::Tracks& tracks,
+                    MidiFormat format=MidiFormat::MultiTrack,
+                    uint8_t divisionType=0,
+                    uint16_t ticksPerQuarter=960) {
+        this->tracks = track::Tracks(tracks);
+        this->format = format;
+        this->divisionType = divisionType;
+        this->ticksPerQuarter = ticksPerQuarter;
+    };
+
+    static MidiFile from_file(const std::string &filepath, const bool internText = false) {
+        FILE *filePtr = fopen(filepath.c_str(), "rb");
+
+        if (!filePtr) {
+            throw std::ios_base::failure("MiniMidi: Reading file failed (fopen)!");
+        }
+        fseek(filePtr, 0, SEEK_END);
+        const size_t fileLen = ftell(filePtr);
+
+        container::Bytes data(fileLen);
+        fseek(filePtr, 0, SEEK_SET);
+        fread(data.data(), 1, fileLen, filePtr);
+        fclose(filePtr);
+
+        return MidiFile(data.data(), fileLen, internText);
+    };
+
+    container::Bytes to_bytes() {
+        std::vector<container::Bytes> trackBytes(tracks.size());
+        size_t trackByteNum = 0;
+        for (auto i = 0; i < tracks.size(); ++i) {
+            trackBytes[i] = tracks[i].to_bytes();
+            trackByteNum += trackBytes[i].size();
+        }
+
+        container::Bytes midiBytes(trackByteNum + 14);
+
+        // Write head
+        std::copy(MTHD.begin(), MTHD.end(), midiBytes.begin());
+        midiBytes[7] = 0x06;  // Length of head
+        midiBytes[9] = static_cast<uint8_t>(format);
+        utils::write_msb_bytes(midiBytes.data() + 10, tracks.size(), 2);
+        utils::write_msb_bytes(midiBytes.data() + 12, (divisionType << 15) | ticksPerQuarter, 2);
+
+        // Write track
+        size_t cursor = 14;
+        for (const auto& thisTrackBytes: trackBytes) {
+            std::copy(thisTrackBytes.begin(), thisTrackBytes.end(), midiBytes.begin() + static_cast<long long>(cursor));
+            cursor += thisTrackBytes.size();
+        }
+
+        return midiBytes;
+    };
+
+    container::Bytes to_bytes_sorted() {
+        container::Bytes bytes;
+        size_t approx_size = 32;
+        for(const auto &track: tracks) {
+            approx_size += track.message_num() * 5 + 16;
+        }
+        bytes.reserve(approx_size);
+
+        // Write MIDI HEAD
+        bytes.resize(14);
+        std::uninitialized_copy(MTHD.begin(), MTHD.end(), bytes.begin());
+        bytes[7] = 0x06;
+        bytes[9] = static_cast<uint8_t>(format);
+        utils::write_msb_bytes(bytes.data() + 10, tracks.size(), 2);
+        utils::write_msb_bytes(bytes.data() + 12, (divisionType << 15 | ticksPerQuarter), 2);
+
+        // Write Msgs for Each Track
+        for(const auto& track: tracks) {
+            size_t track_begin = bytes.size();
+            // Write Track HEAD
+            bytes.resize(bytes.size() + 8);
+            std::uninitialized_copy(track::MTRK.begin(), track::MTRK.end(), bytes.end() - 8);
+            // init prev
+            message::Time prevTime = 0;
+            uint8_t prevStatus = 0x00;
+            for(const auto& msg: track.messages) {
+                const message::Time curTime = msg.get_time();
+                const uint8_t curStatus = msg.get_status_byte();
+                // 1. write msg variable length
+                utils::write_variable_length(bytes, utils::delta_time(prevTime, curTime));
+                prevTime = curTime;
+                // 2. write running status
+                if((curStatus == 0xFF) | (curStatus == 0xF0) | (curStatus == 0xF7) | (curStatus != prevStatus)) {
+                    bytes.emplace_back(curStatus);
+                }
+                // 3. write msg btyes, interned text as meta type, length and text
+                if (msg.is_interned()) {
+                    const container::ByteView text = msg.get_meta_bytes();
+                    bytes.emplace_back(msg.get_meta_type_byte());
+                    utils::write_variable_length(bytes, static_cast<uint32_t>(text.size()));
+                    utils::write_iter(bytes, text.begin(), text.end());
+                } else {
+                    const auto& msg_data = msg.get_data();
+                    utils::write_iter(bytes, msg_data.cbegin(), msg_data.cend());
+                }
+                prevStatus = curStatus;
+            }
+            // Write EOT
+            const message::Message _eot = message::Message::EndOfTrack(0);
+            const auto & _eotData = _eot.get_data();
+            utils::write_variable_length(bytes, 1);
+            bytes.emplace_back(_eot.get_status_byte());
+            utils::write_iter(bytes, _eotData.cbegin(), _eotData.cend());
+
+            // Write track chunk length after MTRK
+            utils::write_msb_bytes(
+                bytes.data() + track_begin + 4,
+                bytes.size() - track_begin - 8,
+                4
+            );
+            // Track Writting Finished
+        }
+        return std::move(bytes);
+    }
+
+    void write_file(const std::string &filepath) {
+        FILE *filePtr = fopen(filepath.c_str(), "wb");
+
+        if (!filePtr) {
+            throw std::ios_base::failure("MiniMidi: Create file failed (fopen)!");
+        }
+        const container::Bytes midiBytes = this->to_bytes();
+        fwrite(midiBytes.data(), 1, midiBytes.size(), filePtr);
+        fclose(filePtr);
+    };
+
+    [[nodiscard]] MidiFormat get_format() const {
+        return this->format;
+    };
+
+    [[nodiscard]] std::string get_format_string() const {
+        return format_to_string(this->get_format());
+    }
+
+    [[nodiscard]] uint16_t get_division_type() const {
+        return this->divisionType;
+    };
+
+    // Division type 1 have no tpq, 0xFFFF is returned.
+    [[nodiscard]] uint16_t get_tick_per_quarter() const {
+        if (!this->get_division_type()) return this->ticksPerQuarter;
+        else return -1;
+    };
+
+    [[nodiscard]] uint16_t get_frame_per_second() const {
+        return (~(this->negativeSmpte - 1)) & 0x3F;
+    };
+
+    // Division type 0 have no tps, 0xFFFF is returned.
+    [[nodiscard]] uint16_t get_tick_per_second() const {
+        if (this->get_division_type()) return this->ticksPerFrame * this->get_frame_per_second();
+        else return -1;
+    };
+
+    track::Track &track(const uint32_t index) {
+        return this->tracks[index];
+    };
+
+    [[nodiscard]] const track::Track &track(const uint32_t index) const {
+        return this->tracks[index];
+    };
+
+    [[nodiscard]] size_t track_num() const {
+        return this->tracks.size();
+    };
+};
+
+#undef MIDI_FORMAT
+
+}
+
+}
+
+#endif //MINIMIDI_CORE_HPP
@@ -0,0 +1,347 @@
+#ifndef MINIMIDI_DUMP_HPP
+#define MINIMIDI_DUMP_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<cstdio>
+#include<charconv>
+#include<string>
+#include<string_view>
+#include<unordered_map>
+#include"Core.hpp"
+
+namespace minimidi {
+
+namespace dump {
+
+// Single pass parser of the text written by operator<<(std::ostream &, const MidiFile &),
+// e.g. by example/dumpmidi. Text meta values containing line breaks can not be parsed back.
+class Parser {
+    const char *cursor;
+    const char *end;
+    size_t line = 1;
+
+    [[noreturn]] void fail(const std::string &what) const {
+        throw std::ios_base::failure(
+            "MiniMidi: Invalid dump at line " + std::to_string(line) + ": " + what + "!"
+        );
+    };
+
+    bool consume(const std::string_view literal) {
+        if (static_cast<size_t>(end - cursor) < literal.size() ||
+            std::string_view(cursor, literal.size()) != literal) return false;
+        cursor += literal.size();
+        return true;
+    };
+
+    void expect(const std::string_view literal) {
+        if (!consume(literal)) fail("expected \"" + std::string(literal) + "\"");
+    };
+
+    template<typename Int>
+    Int number() {
+        Int value = 0;
+        const auto [ptr, ec] = std::from_chars(cursor, end, value);
+        if (ec != std::errc()) fail("expected a number");
+        cursor = ptr;
+        return value;
+    }
+
+    // rest of the line, the line break is consumed
+    std::string_view rest_of_line() {
+        const char *begin = cursor;
+        while (cursor < end && *cursor != '\n') ++cursor;
+        const std::string_view text(begin, cursor - begin);
+        if (cursor < end) {
+            ++cursor;
+            ++line;
+        }
+        return text;
+    };
+
+    void end_of_line() {
+        if (cursor < end) {
+            if (*cursor != '\n') fail("unexpected \"" + std::string(rest_of_line()) + "\"");
+            ++cursor;
+            ++line;
+        }
+    };
+
+    // { 0a 1b ... }
+    container::SmallBytes hex_bytes() {
+        static constexpr auto digit = [](const char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+        container::SmallBytes bytes;
+        expect("{ ");
+        while (!consume("}")) {
+            if (end - cursor < 3) fail("unterminated bytes");
+            const int high = digit(cursor[0]), low = digit(cursor[1]);
+            if (high < 0 || low < 0 || cursor[2] != ' ') fail("invalid hex byte");
+            bytes.push_back(static_cast<uint8_t>((high << 4) | low));
+            cursor += 3;
+        }
+        return bytes;
+    };
+
+    static const std::unordered_map<std::string_view, message::MessageType> &message_types() {
+        static const std::vector<std::string> names = [] {
+            std::vector<std::string> result;
+            for (const auto &attr: message::MESSAGE_ATTRS) result.push_back(message::message_type_to_string(attr.type));
+            return result;
+        }();
+        static const std::unordered_map<std::string_view, message::MessageType> types = [] {
+            std::unordered_map<std::string_view, message::MessageType> result;
+            for (size_t i = 0; i < names.size(); ++i) result.emplace(names[i], message::MESSAGE_ATTRS[i].type);
+            return result;
+        }();
+        return types;
+    };
+
+    static const std::unordered_map<std::string_view, message::MetaType> &meta_types() {
+        static const std::vector<std::pair<std::string, message::MetaType>> names = [] {
+            std::vector<std::pair<std::string, message::MetaType>> result;
+            for (size_t i = 0; i < 256; ++i) {
+                const message::MetaType type = message::status_to_meta_type(static_cast<uint8_t>(i));
+                if (type != message::MetaType::Unknown || i == 0xFF)
+                    result.emplace_back(message::meta_type_to_string(type), type);
+            }
+            return result;
+        }();
+        static const std::unordered_map<std::string_view, message::MetaType> types = [] {
+            std::unordered_map<std::string_view, message::MetaType> result;
+            for (const auto &[name, type]: names) result.emplace(name, type);
+            return result;
+        }();
+        return types;
+    };
+
+    // name inside delimiters, e.g. [NoteOn] or (SetTempo)
+    std::string_view name(const char open, const char close) {
+        if (cursor >= end || *cursor != open) fail(std::string("expected '") + open + "'");
+        const char *begin = ++cursor;
+        while (cursor < end && *cursor != close && *cursor != '\n') ++cursor;
+        if (cursor >= end || *cursor != close) fail(std::string("expected '") + close + "'");
+        return {begin, static_cast<size_t>(cursor++ - begin)};
+    };
+
+    // "<meta type> value={ ... }", also written for values the dedicated forms can not show
+    [[nodiscard]] bool at_raw_meta() const {
+        const char *ptr = cursor;
+        while (ptr < end && *ptr >= '0' && *ptr <= '9') ++ptr;
+        return ptr != cursor && std::string_view(ptr, std::min<size_t>(7, end - ptr)) == " value=";
+    };
+
+    message::Message raw_meta(const message::Time time) {
+        const auto metaType = number<uint8_t>();
+        expect(" value=");
+        const container::SmallBytes value = hex_bytes();
+        end_of_line();
+        return message::Message::Meta(time, static_cast<message::MetaType>(metaType), value);
+    };
+
+    message::Message meta_message(const message::Time time) {
+        const std::string_view metaName = name('(', ')');
+        const auto it = meta_types().find(metaName);
+        if (it == meta_types().end()) fail("unknown meta type " + std::string(metaName));
+        expect(" ");
+        const bool isText = it->second == message::MetaType::TrackName ||
+            it->second == message::MetaType::InstrumentName;
+        if (!isText && at_raw_meta()) return raw_meta(time);
+
+        switch (it->second) {
+            case message::MetaType::TrackName:
+            case message::MetaType::InstrumentName: {
+                return message::Message::Meta(time, it->second, std::string(rest_of_line()));
+            };
+            case message::MetaType::TimeSignature: {
+                const auto numerator = number<uint8_t>();
+                expect("/");
+                auto denominator = number<uint32_t>();
+                uint8_t power = 0;
+                while ((1u << (power + 1)) <= denominator) ++power;
+                uint8_t clocks = 0x18, notated32nds = 0x08;
+                if (consume(" clocks=")) {
+                    clocks = number<uint8_t>();
+                    expect(" notated32nds=");
+                    notated32nds = number<uint8_t>();
+                }
+                end_of_line();
+                return message::Message::Meta(time, it->second,
+                    container::SmallBytes{numerator, power, clocks, notated32nds});
+            };
+            case message::MetaType::SetTempo: {
+                const auto tempo = number<uint32_t>();
+                end_of_line();
+                return message::Message::SetTempo(time, tempo);
+            };
+            case message::MetaType::KeySignature: {
+                const std::string_view keyName = rest_of_line();
+                for (size_t i = 0; i < std::size(message::KEYS_NAME); ++i) {
+                    if (message::KEYS_NAME[i] == keyName)
+                        return message::Message::KeySignature(time, static_cast<int8_t>(i % 15) - 7, i / 15);
+                }
+                fail("unknown key " + std::string(keyName));
+            };
+            case message::MetaType::EndOfTrack: {
+                end_of_line();
+                return message::Message::EndOfTrack(time);
+            };
+            default: {
+                return raw_meta(time);
+            };
+        }
+    };
+
+    message::Message message(const message::Time time) {
+        const std::string_view typeName = name('[', ']');
+        const auto it = message_types().find(typeName);
+        if (it == message_types().end()) fail("unknown message type " + std::string(typeName));
+        expect(" ");
+
+        switch (it->second) {
+            case message::MessageType::NoteOn:
+            case message::MessageType::NoteOff: {
+                expect("channel=");
+                const auto channel = number<uint8_t>();
+                expect(" pitch=");
+                const auto pitch = number<uint8_t>();
+                expect(" velocity=");
+                const auto velocity = number<uint8_t>();
+                end_of_line();
+                return it->second == message::MessageType::NoteOn
+                    ? message::Message::NoteOn(time, channel, pitch, velocity)
+                    : message::Message::NoteOff(time, channel, pitch, velocity);
+            };
+            case message::MessageType::ProgramChange: {
+                expect("channel=");
+                const auto channel = number<uint8_t>();
+                expect(" program=");
+                const auto program = number<uint8_t>();
+                end_of_line();
+                return message::Message::ProgramChange(time, channel, program);
+            };
+            case message::MessageType::ControlChange: {
+                expect("channel=");
+                const auto channel = number<uint8_t>();
+                expect(" control number=");
+                const auto controlNumber = number<uint8_t>();
+                expect(" control value=");
+                const auto controlValue = number<uint8_t>();
+                end_of_line();
+                return message::Message::ControlChange(time, channel, controlNumber, controlValue);
+            };
+            case message::MessageType::Meta: {
+                return meta_message(time);
+            };
+            default: {
+                expect("Status code: ");
+                const auto status = number<uint8_t>();
+                expect(" length=");
+                const auto length = number<size_t>();
+                expect(" value=");
+                container::SmallBytes data = hex_bytes();
+                if (data.size() != length) fail("length does not match the value");
+                end_of_line();
+                return {time, status, std::move(data)};
+            };
+        }
+    };
+
+public:
+    Parser(const char *data, const size_t size): cursor(data), end(data + size) {};
+
+    file::MidiFile parse() {
+        expect("File format: ");
+        const std::string_view formatName = rest_of_line();
+        file::MidiFormat format = file::MidiFormat::MultiTrack;
+        bool knownFormat = false;
+        for (const auto candidate: {file::MidiFormat::SingleTrack, file::MidiFormat::MultiTrack,
+                                    file::MidiFormat::MultiSong}) {
+            if (file::format_to_string(candidate) == formatName) {
+                format = candidate;
+                knownFormat = true;
+            }
+        }
+        if (!knownFormat) fail("unknown format " + std::string(formatName));
+
+        expect("Division:\n");
+        ++line;
+        expect("    Type: ");
+        const auto divisionType = number<uint8_t>();
+        end_of_line();
+
+        file::MidiFile midiFile(format, divisionType, 0);
+        if (divisionType) {
+            expect("    Tick per Second: ");
+            number<uint32_t>();
+            end_of_line();
+            expect("    Frame per Second: ");
+            const auto fps = number<uint16_t>();
+            end_of_line();
+            expect("    Tick per Frame: ");
+            const auto ticksPerFrame = number<uint16_t>();
+            end_of_line();
+            midiFile.negativeSmpte = (-fps) & 0x7F;
+            midiFile.ticksPerFrame = ticksPerFrame;
+        } else {
+            expect("    Tick per Quarter: ");
+            midiFile.ticksPerQuarter = number<uint16_t>();
+            end_of_line();
+        }
+        end_of_line();
+
+        while (cursor < end) {
+            expect("Track ");
+            number<size_t>();
+            expect(": ");
+            end_of_line();
+
+            track::Track &track = midiFile.tracks.emplace_back();
+            // a track ends with an empty line
+            while (cursor < end && *cursor != '\n') {
+                expect("time=");
+                const auto time = number<message::Time>();
+                expect(" | ");
+                track.messages.emplace_back(message(time));
+            }
+            end_of_line();
+        }
+
+        return midiFile;
+    };
+};
+
+inline file::MidiFile parse(const char *data, const size_t size) {
+    return Parser(data, size).parse();
+};
+
+inline file::MidiFile parse(const std::string_view text) {
+    return parse(text.data(), text.size());
+};
+
+inline file::MidiFile read_file(const std::string &filepath) {
+    FILE *filePtr = fopen(filepath.c_str(), "rb");
+
+    if (!filePtr) {
+        throw std::ios_base::failure("MiniMidi: Reading file failed (fopen)!");
+    }
+    fseek(filePtr, 0, SEEK_END);
+    const size_t fileLen = ftell(filePtr);
+
+    std::string text(fileLen, '\0');
+    fseek(filePtr, 0, SEEK_SET);
+    fread(text.data(), 1, fileLen, filePtr);
+    fclose(filePtr);
+
+    return parse(text);
+};
+
+}
+
+}
+
+#endif //MINIMIDI_DUMP_HPP
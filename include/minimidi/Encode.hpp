@@ -0,0 +1,222 @@
+#ifndef MINIMIDI_ENCODE_HPP
+#define MINIMIDI_ENCODE_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<array>
+#include<string_view>
+#include<stdexcept>
+#include"Core.hpp"
+
+namespace minimidi {
+
+namespace encode {
+
+constexpr uint32_t MAX_VARIABLE_LENGTH = utils::MAX_VARIABLE_LENGTH;
+
+// Midi file encoder into a fixed-capacity byte array, usable in constant expressions, e.g.
+//
+//     constexpr auto COUNT_IN = [] {
+//         encode::Writer<128> writer(file::MidiFormat::SingleTrack, 480);
+//         writer.begin_track();
+//         for (uint32_t beat = 0; beat < 4; ++beat) {
+//             writer.note_on(beat * 480, 9, 37, 100);
+//             writer.note_off(beat * 480 + 240, 9, 37);
+//         }
+//         writer.end_track();
+//         return writer;
+//     }();
+//     constexpr auto COUNT_IN_BYTES = encode::trim<COUNT_IN.size()>(COUNT_IN);
+//
+// Overflowing the capacity or writing events out of time order throws, which makes such
+// mistakes compile errors in constant expressions. Channel messages use running status.
+template<size_t Capacity>
+class Writer {
+    std::array<uint8_t, Capacity> buffer{};
+    size_t length = 0;
+    size_t trackBegin = 0;
+    message::Time prevTime = 0;
+    uint8_t prevStatus = 0x00;
+    uint16_t trackNum = 0;
+    bool inTrack = false;
+    bool hasEndOfTrack = false;
+
+    constexpr void reserve(const size_t size) {
+        if (length + size > Capacity) throw std::length_error("MiniMidi: Writer capacity exceeded!");
+    };
+
+    constexpr void put(const uint8_t byte) {
+        buffer[length++] = byte;
+    };
+
+    constexpr void put_variable_length(const uint32_t num) {
+        if (num > MAX_VARIABLE_LENGTH) throw std::invalid_argument("MiniMidi: Variable length quantity overflow!");
+        uint8_t *cursor = buffer.data() + length;
+        utils::write_variable_length(cursor, num);
+        length = cursor - buffer.data();
+    };
+
+    constexpr void put_delta(const message::Time time) {
+        if (!inTrack) throw std::logic_error("MiniMidi: Writing an event outside of a track!");
+        if (hasEndOfTrack) throw std::logic_error("MiniMidi: Writing an event after end of track!");
+        if (time < prevTime) throw std::invalid_argument("MiniMidi: Events must be written in time order!");
+        if (time - prevTime > MAX_VARIABLE_LENGTH) throw std::invalid_argument("MiniMidi: Variable length quantity overflow!");
+        const auto delta = static_cast<uint32_t>(time - prevTime);
+        reserve(utils::calc_variable_length(delta));
+        put_variable_length(delta);
+        prevTime = time;
+    };
+
+    constexpr void channel_message(const message::Time time, const uint8_t status, const uint8_t data1,
+                                   const uint8_t data2, const size_t dataLen) {
+        put_delta(time);
+        const bool running = status == prevStatus;
+        reserve(!running + dataLen);
+        if (!running) put(status);
+        put(data1);
+        if (dataLen > 1) put(data2);
+        prevStatus = status;
+    };
+
+    template<typename Byte>
+    constexpr void put_meta(const message::Time time, const message::MetaType metaType, const Byte *value, const size_t size) {
+        put_delta(time);
+        reserve(2 + utils::calc_variable_length(static_cast<uint32_t>(size)) + size);
+        put(message::message_status<message::MessageType::Meta>());
+        put(static_cast<uint8_t>(metaType));
+        put_variable_length(static_cast<uint32_t>(size));
+        for (size_t i = 0; i < size; ++i) put(static_cast<uint8_t>(value[i]));
+        // meta and SysEx cancel running status
+        prevStatus = 0x00;
+        if (metaType == message::MetaType::EndOfTrack) hasEndOfTrack = true;
+    };
+
+public:
+    constexpr Writer(const file::MidiFormat format, const uint16_t ticksPerQuarter, const uint16_t divisionType = 0) {
+        reserve(14);
+        for (const char c: std::string_view("MThd")) put(static_cast<uint8_t>(c));
+        put(0); put(0); put(0); put(6);
+        put(0); put(static_cast<uint8_t>(format));
+        // track number, written by end_track
+        put(0); put(0);
+        const uint16_t division = static_cast<uint16_t>((divisionType << 15) | ticksPerQuarter);
+        put(static_cast<uint8_t>(division >> 8));
+        put(static_cast<uint8_t>(division & 0xFF));
+    };
+
+    [[nodiscard]] constexpr const uint8_t *data() const { return buffer.data(); };
+
+    [[nodiscard]] constexpr size_t size() const { return length; };
+
+    [[nodiscard]] constexpr uint16_t track_num() const { return trackNum; };
+
+    [[nodiscard]] constexpr uint8_t operator[](const size_t index) const { return buffer[index]; };
+
+    constexpr void begin_track() {
+        if (inTrack) throw std::logic_error("MiniMidi: Previous track is not ended!");
+        reserve(8);
+        trackBegin = length;
+        for (const char c: std::string_view("MTrk")) put(static_cast<uint8_t>(c));
+        put(0); put(0); put(0); put(0);
+        prevTime = 0;
+        prevStatus = 0x00;
+        inTrack = true;
+        hasEndOfTrack = false;
+    };
+
+    // Close the current track, appending an end of track event at the last event time if none was written.
+    constexpr void end_track() {
+        if (!inTrack) throw std::logic_error("MiniMidi: No track to end!");
+        if (!hasEndOfTrack) end_of_track(prevTime);
+        utils::write_msb_bytes(buffer.data() + trackBegin + 4, length - trackBegin - 8, 4);
+        inTrack = false;
+        ++trackNum;
+        utils::write_msb_bytes(buffer.data() + 10, trackNum, 2);
+    };
+
+    constexpr void note_on(const message::Time time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity) {
+        channel_message(time, message::message_status<message::MessageType::NoteOn>() | channel, pitch, velocity, 2);
+    };
+
+    constexpr void note_off(const message::Time time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity = 0) {
+        channel_message(time, message::message_status<message::MessageType::NoteOff>() | channel, pitch, velocity, 2);
+    };
+
+    constexpr void control_change(const message::Time time, const uint8_t channel, const uint8_t controlNumber,
+                                  const uint8_t controlValue) {
+        channel_message(time, message::message_status<message::MessageType::ControlChange>() | channel,
+                        controlNumber, controlValue, 2);
+    };
+
+    constexpr void program_change(const message::Time time, const uint8_t channel, const uint8_t program) {
+        channel_message(time, message::message_status<message::MessageType::ProgramChange>() | channel, program, 0, 1);
+    };
+
+    constexpr void pitch_bend(const message::Time time, const uint8_t channel, const int16_t value) {
+        const auto raw = static_cast<uint16_t>(value - message::MIN_PITCHBEND);
+        channel_message(time, message::message_status<message::MessageType::PitchBend>() | channel,
+                        raw & 0x7F, (raw >> 7) & 0x7F, 2);
+    };
+
+    constexpr void meta(const message::Time time, const message::MetaType metaType, const uint8_t *value, const size_t size) {
+        put_meta(time, metaType, value, size);
+    };
+
+    constexpr void text(const message::Time time, const message::MetaType metaType, const std::string_view text) {
+        put_meta(time, metaType, text.data(), text.size());
+    };
+
+    constexpr void track_name(const message::Time time, const std::string_view name) {
+        text(time, message::MetaType::TrackName, name);
+    };
+
+    constexpr void set_tempo(const message::Time time, const uint32_t tempo) {
+        const uint8_t value[] = {
+            static_cast<uint8_t>((tempo >> 16) & 0xFF),
+            static_cast<uint8_t>((tempo >> 8) & 0xFF),
+            static_cast<uint8_t>(tempo & 0xFF)
+        };
+        meta(time, message::MetaType::SetTempo, value, 3);
+    };
+
+    constexpr void time_signature(const message::Time time, const uint8_t numerator, const uint8_t denominator) {
+        uint8_t power = 0;
+        while ((1 << (power + 1)) <= denominator) ++power;
+        const uint8_t value[] = {numerator, power, 0x18, 0x08};
+        meta(time, message::MetaType::TimeSignature, value, 4);
+    };
+
+    constexpr void key_signature(const message::Time time, const int8_t key, const uint8_t tonality) {
+        const uint8_t value[] = {static_cast<uint8_t>(key), tonality};
+        meta(time, message::MetaType::KeySignature, value, 2);
+    };
+
+    constexpr void end_of_track(const message::Time time) {
+        put_meta(time, message::MetaType::EndOfTrack, static_cast<const uint8_t *>(nullptr), 0);
+    };
+
+    // SysEx message, body without the leading 0xF0, the trailing 0xF7 is appended
+    constexpr void sysex(const message::Time time, const uint8_t *body, const size_t size) {
+        put_delta(time);
+        reserve(1 + utils::calc_variable_length(static_cast<uint32_t>(size + 1)) + size + 1);
+        put(message::message_status<message::MessageType::SysExStart>());
+        put_variable_length(static_cast<uint32_t>(size + 1));
+        for (size_t i = 0; i < size; ++i) put(body[i]);
+        put(message::message_status<message::MessageType::SysExEnd>());
+        prevStatus = 0x00;
+    };
+};
+
+// Copy the first Size bytes of a writer into an exactly sized array.
+template<size_t Size, size_t Capacity>
+constexpr std::array<uint8_t, Size> trim(const Writer<Capacity> &writer) {
+    std::array<uint8_t, Size> result{};
+    for (size_t i = 0; i < Size && i < writer.size(); ++i) result[i] = writer[i];
+    return result;
+};
+
+}
+
+}
+
+#endif //MINIMIDI_ENCODE_HPP
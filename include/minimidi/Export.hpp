@@ -0,0 +1,356 @@
+#ifndef MINIMIDI_EXPORT_HPP
+#define MINIMIDI_EXPORT_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<cstdio>
+#include<charconv>
+#include<string>
+#include<string_view>
+#include<vector>
+#include<array>
+#include<algorithm>
+#include"Core.hpp"
+#include"Timing.hpp"
+#include"Note.hpp"
+
+namespace minimidi {
+
+namespace csv {
+
+typedef struct {
+    // ',' for CSV, '\t' for TSV
+    char delimiter;
+    // add columns in seconds, computed from the SetTempo events
+    bool seconds;
+    // write the column names as the first line
+    bool header;
+} ExportOptions;
+
+constexpr ExportOptions DEFAULT_EXPORT_OPTIONS = {',', false, true};
+
+// Buffered text output: numbers are formatted with std::to_chars directly into a large
+// buffer, written out with fwrite whenever it fills up.
+class Writer {
+    std::FILE *file;
+    bool owned;
+    std::vector<char> buffer;
+    size_t used = 0;
+    size_t written = 0;
+
+    char *reserve(const size_t size) {
+        if (used + size > buffer.size()) {
+            this->flush();
+            if (size > buffer.size()) buffer.resize(size);
+        }
+        return buffer.data() + used;
+    };
+
+public:
+    // Write into an open file (e.g. stdout), which is not closed by the writer.
+    explicit Writer(std::FILE *file, const size_t capacity = 1 << 20):
+        file(file), owned(false), buffer(capacity) {};
+
+    explicit Writer(const std::string &filepath, const size_t capacity = 1 << 20):
+        file(fopen(filepath.c_str(), "wb")), owned(true), buffer(capacity) {
+        if (!file) {
+            throw std::ios_base::failure("MiniMidi: Opening file failed (fopen)!");
+        }
+    };
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    // Errors can not be reported from here, call close() to check them.
+    ~Writer() {
+        try {
+            this->close();
+        } catch (...) {}
+    };
+
+    void flush() {
+        if (!used) return;
+        if (!file) {
+            throw std::logic_error("MiniMidi: Writing to a closed csv::Writer!");
+        }
+        if (fwrite(buffer.data(), 1, used, file) != used) {
+            throw std::ios_base::failure("MiniMidi: Writing file failed (fwrite)!");
+        }
+        written += used;
+        used = 0;
+    };
+
+    // Write the buffer out and close the file (or flush it, if the writer does not own it).
+    // The file is closed even if writing fails; errors are reported afterwards.
+    void close() {
+        if (!file) return;
+        bool failed = used && fwrite(buffer.data(), 1, used, file) != used;
+        written += used;
+        used = 0;
+        failed |= (owned ? fclose(file) : fflush(file)) != 0;
+        file = nullptr;
+        if (failed) {
+            throw std::ios_base::failure("MiniMidi: Writing file failed (fwrite)!");
+        }
+    };
+
+    // bytes written so far, including the buffered ones
+    [[nodiscard]] size_t size() const { return written + used; };
+
+    void put(const char c) {
+        *reserve(1) = c;
+        ++used;
+    };
+
+    void put(const std::string_view text) {
+        std::copy(text.begin(), text.end(), reserve(text.size()));
+        used += text.size();
+    };
+
+    template<typename Int>
+    void put_int(const Int value) {
+        char *begin = reserve(24);
+        used = std::to_chars(begin, begin + 24, value).ptr - buffer.data();
+    }
+
+    void put_fixed(const double value, const int precision = 6) {
+        char *begin = reserve(64);
+        used = std::to_chars(begin, begin + 64, value, std::chars_format::fixed, precision).ptr - buffer.data();
+    };
+
+    // Quote the text if it contains the delimiter, quotes or line breaks, doubling the quotes.
+    void put_field(const std::string_view text, const char delimiter) {
+        const char special[] = {delimiter, '"', '\n', '\r', '\0'};
+        if (text.find_first_of(special) == std::string_view::npos) {
+            this->put(text);
+            return;
+        }
+        this->put('"');
+        for (const char c: text) {
+            if (c == '"') this->put('"');
+            this->put(c);
+        }
+        this->put('"');
+    };
+
+    void put_hex(const container::ByteView bytes) {
+        static constexpr char DIGITS[] = "0123456789abcdef";
+        char *cursor = reserve(bytes.size() * 2);
+        for (const uint8_t byte: bytes) {
+            *cursor++ = DIGITS[byte >> 4];
+            *cursor++ = DIGITS[byte & 0x0F];
+        }
+        used = cursor - buffer.data();
+    };
+};
+
+// Seconds of the messages of a track, with a single sweep when the track is sorted.
+inline std::vector<double> message_seconds(const timing::TempoMap &tempoMap, const track::Track &track) {
+    std::vector<message::Time> ticks(track.message_num());
+    std::transform(track.messages.begin(), track.messages.end(), ticks.begin(),
+        [](const message::Message &msg) { return msg.get_time(); });
+    std::vector<double> seconds(ticks.size());
+    if (std::is_sorted(ticks.begin(), ticks.end())) {
+        tempoMap.ticks_to_seconds(ticks.begin(), ticks.end(), seconds.begin());
+    } else {
+        std::transform(ticks.begin(), ticks.end(), seconds.begin(),
+            [&tempoMap](const message::Time tick) { return tempoMap.tick_to_second(tick); });
+    }
+    return seconds;
+};
+
+// One line per message: track, tick, [second], type, channel, data1, data2, text
+// Channel messages leave text empty. Meta messages use the meta type name as type,
+// decoded values (tempo, time and key signature, ...) as data1/data2, and the text of
+// text meta messages. SysEx and other binary payloads are written as hex into text.
+inline void write_events(Writer &writer, const file::MidiFile &midiFile,
+                         const ExportOptions &options = DEFAULT_EXPORT_OPTIONS) {
+    const char d = options.delimiter;
+    if (options.header) {
+        writer.put("track");
+        writer.put(d); writer.put("tick");
+        if (options.seconds) { writer.put(d); writer.put("second"); }
+        writer.put(d); writer.put("type");
+        writer.put(d); writer.put("channel");
+        writer.put(d); writer.put("data1");
+        writer.put(d); writer.put("data2");
+        writer.put(d); writer.put("text");
+        writer.put('\n');
+    }
+
+    // type names per status byte and per meta type, built once
+    static const std::array<std::string, 256> typeNames = [] {
+        std::array<std::string, 256> names;
+        for (size_t i = 0; i < 256; ++i) {
+            names[i] = message::message_type_to_string(message::status_to_message_type(static_cast<uint8_t>(i)));
+        }
+        return names;
+    }();
+    static const std::array<std::string, 256> metaNames = [] {
+        std::array<std::string, 256> names;
+        for (size_t i = 0; i < 256; ++i) {
+            names[i] = message::meta_type_to_string(message::status_to_meta_type(static_cast<uint8_t>(i)));
+        }
+        return names;
+    }();
+
+    const timing::TempoMap tempoMap = options.seconds ? timing::TempoMap(midiFile) : timing::TempoMap();
+    std::vector<double> seconds;
+
+    for (size_t t = 0; t < midiFile.track_num(); ++t) {
+        const track::Track &track = midiFile.tracks[t];
+        if (options.seconds) seconds = message_seconds(tempoMap, track);
+
+        for (size_t i = 0; i < track.message_num(); ++i) {
+            const message::Message &msg = track.messages[i];
+            writer.put_int(t);
+            writer.put(d); writer.put_int(msg.get_time());
+            if (options.seconds) { writer.put(d); writer.put_fixed(seconds[i]); }
+            writer.put(d);
+
+            // fields after the type: channel, data1, data2 and the delimiter before text, NONE is left empty
+            constexpr int64_t NONE = INT64_MIN;
+            const auto values = [&writer, d](const int64_t channel, const int64_t data1, const int64_t data2) {
+                for (const int64_t value: {channel, data1, data2}) {
+                    writer.put(d);
+                    if (value != NONE) writer.put_int(value);
+                }
+                writer.put(d);
+            };
+            if (msg.get_type() == message::MessageType::Meta) {
+                writer.put(metaNames[msg.get_meta_type_byte()]);
+                switch (msg.get_meta_type()) {
+                    case message::MetaType::SetTempo: {
+                        values(NONE, msg.get_tempo(), NONE);
+                        break;
+                    };
+                    case message::MetaType::TimeSignature: {
+                        const message::TimeSignature timeSig = msg.get_time_signature();
+                        values(NONE, timeSig.numerator, timeSig.denominator);
+                        break;
+                    };
+                    case message::MetaType::KeySignature: {
+                        const message::KeySignature keySig = msg.get_key_signature();
+                        values(NONE, keySig.key, keySig.tonality);
+                        break;
+                    };
+                    case message::MetaType::SequenceNumber:
+                    case message::MetaType::MIDIChannelPrefix: {
+                        const container::ByteView value = msg.get_meta_bytes();
+                        int64_t number = 0;
+                        for (const uint8_t byte: value) number = (number << 8) | byte;
+                        values(NONE, number, NONE);
+                        break;
+                    };
+                    case message::MetaType::EndOfTrack: {
+                        values(NONE, NONE, NONE);
+                        break;
+                    };
+                    default: {
+                        values(NONE, NONE, NONE);
+                        if (message::is_text_meta(msg.get_meta_type())) writer.put_field(msg.get_meta_text(), d);
+                        else writer.put_hex(msg.get_meta_bytes());
+                        break;
+                    };
+                }
+            } else {
+                const auto &data = msg.get_data();
+                const uint8_t status = msg.get_status_byte();
+                writer.put(typeNames[status]);
+                switch (msg.get_type()) {
+                    case message::MessageType::NoteOff:
+                    case message::MessageType::NoteOn:
+                    case message::MessageType::PolyphonicAfterTouch:
+                    case message::MessageType::ControlChange: {
+                        values(msg.get_channel(), data[0], data[1]);
+                        break;
+                    };
+                    case message::MessageType::ProgramChange:
+                    case message::MessageType::ChannelAfterTouch: {
+                        values(msg.get_channel(), data[0], NONE);
+                        break;
+                    };
+                    case message::MessageType::PitchBend: {
+                        values(msg.get_channel(), msg.get_pitch_bend(), NONE);
+                        break;
+                    };
+                    case message::MessageType::SongPositionPointer: {
+                        values(NONE, msg.get_song_position_pointer(), NONE);
+                        break;
+                    };
+                    case message::MessageType::QuarterFrame: {
+                        values(NONE, msg.get_frame_type(), msg.get_frame_value());
+                        break;
+                    };
+                    case message::MessageType::SongSelect: {
+                        values(NONE, data[0], NONE);
+                        break;
+                    };
+                    case message::MessageType::SysExStart: {
+                        values(NONE, NONE, NONE);
+                        writer.put_hex(msg.get_sysex_bytes());
+                        break;
+                    };
+                    default: {
+                        values(NONE, NONE, NONE);
+                        writer.put_hex({data.data(), data.size()});
+                        break;
+                    };
+                }
+            }
+            writer.put('\n');
+        }
+    }
+};
+
+// One line per note (see note::extract_notes), in onset order:
+// track, onset, duration, [onset_second, duration_second], channel, pitch, velocity
+inline void write_notes(Writer &writer, const file::MidiFile &midiFile,
+                        const ExportOptions &options = DEFAULT_EXPORT_OPTIONS) {
+    const char d = options.delimiter;
+    if (options.header) {
+        writer.put("track");
+        writer.put(d); writer.put("onset");
+        writer.put(d); writer.put("duration");
+        if (options.seconds) {
+            writer.put(d); writer.put("onset_second");
+            writer.put(d); writer.put("duration_second");
+        }
+        writer.put(d); writer.put("channel");
+        writer.put(d); writer.put("pitch");
+        writer.put(d); writer.put("velocity");
+        writer.put('\n');
+    }
+
+    const note::NoteList notes = note::extract_notes(midiFile);
+    std::vector<double> onsets;
+    timing::TempoMap tempoMap;
+    if (options.seconds) {
+        tempoMap = timing::TempoMap(midiFile);
+        std::vector<message::Time> ticks(notes.size());
+        std::transform(notes.begin(), notes.end(), ticks.begin(), [](const note::Note &n) { return n.onset; });
+        onsets.resize(ticks.size());
+        tempoMap.ticks_to_seconds(ticks.begin(), ticks.end(), onsets.begin());
+    }
+
+    for (size_t i = 0; i < notes.size(); ++i) {
+        const note::Note &n = notes[i];
+        writer.put_int(n.track);
+        writer.put(d); writer.put_int(n.onset);
+        writer.put(d); writer.put_int(n.duration);
+        if (options.seconds) {
+            writer.put(d); writer.put_fixed(onsets[i]);
+            writer.put(d); writer.put_fixed(tempoMap.tick_to_second(n.onset + n.duration) - onsets[i]);
+        }
+        writer.put(d); writer.put_int(n.channel);
+        writer.put(d); writer.put_int(n.pitch);
+        writer.put(d); writer.put_int(n.velocity);
+        writer.put('\n');
+    }
+};
+
+}
+
+}
+
+#endif //MINIMIDI_EXPORT_HPP
@@ -0,0 +1,41 @@
+#ifndef MINIMIDI_FILTER_HPP
+#define MINIMIDI_FILTER_HPP
+
+#include<vector>
+#include<iterator>
+#include<algorithm>
+#include<functional>
+#include"Core.hpp"
+
+namespace minimidi {
+
+namespace message {
+
+inline Messages filter_message(const Messages& messages, const std::function<bool(const Message &)> &filter) {
+    Messages new_messages;
+    new_messages.reserve(messages.size());
+    std::copy_if(messages.begin(),
+                messages.end(),
+                std::back_inserter(new_messages),
+                filter);
+    new_messages.shrink_to_fit();
+    return new_messages;
+};
+
+// Templated predicate avoids the std::function indirection,
+// and the result keeps its reservation instead of being copied again by shrink_to_fit.
+template<typename Pred>
+Messages filter_message(const Messages& messages, Pred &&filter) {
+    Messages new_messages;
+    new_messages.reserve(messages.size());
+    for (const auto &msg: messages) {
+        if (filter(msg)) new_messages.emplace_back(msg);
+    }
+    return new_messages;
+};
+
+}
+
+}
+
+#endif //MINIMIDI_FILTER_HPP
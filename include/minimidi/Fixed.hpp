@@ -0,0 +1,395 @@
+#ifndef MINIMIDI_FIXED_HPP
+#define MINIMIDI_FIXED_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<cstring>
+#include<array>
+#include"Types.hpp"
+
+namespace minimidi {
+
+// Midi files in caller-provided fixed-capacity storage, for targets where allocating at
+// runtime is not allowed. Nothing here allocates or throws, errors are reported with
+// Status, and only Types.hpp is included, so it compiles with -fno-exceptions.
+namespace fixed {
+
+enum class Status : uint8_t {
+    Ok,
+    InvalidHeader,
+    Truncated,
+    InvalidEvent,
+    TooManyTracks,
+    TooManyEvents,
+    PayloadFull,
+};
+
+constexpr const char *status_to_string(const Status status) {
+    switch (status) {
+        case Status::Ok: return "Ok";
+        case Status::InvalidHeader: return "InvalidHeader";
+        case Status::Truncated: return "Truncated";
+        case Status::InvalidEvent: return "InvalidEvent";
+        case Status::TooManyTracks: return "TooManyTracks";
+        case Status::TooManyEvents: return "TooManyEvents";
+        case Status::PayloadFull: return "PayloadFull";
+    }
+    return "Unknown";
+};
+
+typedef struct {
+    message::Time time;
+    // the bytes after the status byte in the payload pool, as the data of message::Message
+    uint32_t offset;
+    uint16_t size;
+    uint8_t statusByte;
+} Event;
+
+typedef struct {
+    uint32_t firstEvent;
+    uint32_t eventNum;
+} TrackEntry;
+
+// Non-owning view of an event in a FixedMidiFile.
+class MessageView {
+    const Event *event;
+    const uint8_t *payload;
+
+public:
+    constexpr MessageView(): event(nullptr), payload(nullptr) {};
+    constexpr MessageView(const Event *event, const uint8_t *payload): event(event), payload(payload) {};
+
+    [[nodiscard]] constexpr message::Time get_time() const { return event->time; };
+
+    [[nodiscard]] constexpr uint8_t get_status_byte() const { return event->statusByte; };
+
+    [[nodiscard]] constexpr const uint8_t *data() const { return payload + event->offset; };
+
+    [[nodiscard]] constexpr size_t size() const { return event->size; };
+
+    [[nodiscard]] constexpr message::MessageType get_type() const {
+        return message::status_to_message_type(event->statusByte);
+    };
+
+    [[nodiscard]] constexpr uint8_t get_channel() const { return event->statusByte & 0x0F; };
+
+    [[nodiscard]] constexpr uint8_t get_pitch() const { return data()[0]; };
+
+    [[nodiscard]] constexpr uint8_t get_velocity() const { return data()[1]; };
+
+    [[nodiscard]] constexpr uint8_t get_control_number() const { return data()[0]; };
+
+    [[nodiscard]] constexpr uint8_t get_control_value() const { return data()[1]; };
+
+    [[nodiscard]] constexpr uint8_t get_program() const { return data()[0]; };
+
+    [[nodiscard]] constexpr int16_t get_pitch_bend() const {
+        return static_cast<int16_t>(data()[0] + (data()[1] << 7) + message::MIN_PITCHBEND);
+    };
+
+    [[nodiscard]] constexpr message::MetaType get_meta_type() const {
+        return message::status_to_meta_type(data()[0]);
+    };
+
+    // Meta value after the meta type and the length, meta messages only.
+    [[nodiscard]] constexpr const uint8_t *meta_value() const {
+        const uint8_t *cursor = data() + 1;
+        utils::read_variable_length(cursor);
+        return cursor;
+    };
+
+    [[nodiscard]] constexpr size_t meta_size() const {
+        return size() - (meta_value() - data());
+    };
+
+    [[nodiscard]] constexpr uint32_t get_tempo() const {
+        return static_cast<uint32_t>(utils::read_msb_bytes(meta_value(), 3));
+    };
+};
+
+// Non-owning view of a track in a FixedMidiFile.
+class TrackView {
+    const Event *events;
+    size_t eventNum;
+    const uint8_t *payload;
+
+public:
+    constexpr TrackView(const Event *events, const size_t eventNum, const uint8_t *payload):
+        events(events), eventNum(eventNum), payload(payload) {};
+
+    [[nodiscard]] constexpr MessageView message(const size_t index) const {
+        return {events + index, payload};
+    };
+
+    [[nodiscard]] constexpr size_t message_num() const {
+        return this->eventNum;
+    };
+};
+
+// Midi file parsed into arrays owned by the caller: an array of events, a pool for the
+// data bytes of all events and an array of tracks. Parsing into a full array fails with
+// TooManyEvents, PayloadFull or TooManyTracks and leaves the file empty.
+class FixedMidiFile {
+    Event *events;
+    size_t eventCapacity;
+    uint8_t *payload;
+    size_t payloadCapacity;
+    TrackEntry *tracks;
+    size_t trackCapacity;
+    size_t eventNum = 0;
+    size_t payloadSize = 0;
+    size_t trackNum = 0;
+    uint16_t format = 0;
+    uint16_t division = 0;
+
+    // variable length quantity, false if it runs past end
+    static constexpr bool read_variable_length(const uint8_t *&cursor, const uint8_t *end, uint32_t &value) {
+        value = 0;
+        for (auto i = 0; i < 4; ++i) {
+            if (cursor >= end) return false;
+            const uint8_t byte = *cursor++;
+            value = (value << 7) | (byte & 0x7F);
+            if (!(byte & 0x80)) return true;
+        }
+        return true;
+    };
+
+    Status append(const message::Time time, const uint8_t statusByte, const uint8_t *data, const size_t size) {
+        if (eventNum == eventCapacity) return Status::TooManyEvents;
+        if (size > UINT16_MAX) return Status::InvalidEvent;
+        if (size > payloadCapacity - payloadSize) return Status::PayloadFull;
+        if (size) std::memcpy(payload + payloadSize, data, size);
+        events[eventNum++] = {time, static_cast<uint32_t>(payloadSize), static_cast<uint16_t>(size), statusByte};
+        payloadSize += size;
+        return Status::Ok;
+    };
+
+    // Same decoding as track::Track.
+    Status parse_track(const uint8_t *cursor, const uint8_t *end) {
+        message::Time time = 0;
+        uint8_t prevStatus = 0x00;
+        size_t prevLength = 0;
+
+        while (cursor < end) {
+            uint32_t delta = 0;
+            if (!read_variable_length(cursor, end, delta) || cursor >= end) return Status::Truncated;
+            if (time > message::MAX_TIME - delta) return Status::InvalidEvent;
+            time += delta;
+            Status status = Status::Ok;
+
+            // Running status
+            if (const uint8_t curStatus = *cursor; curStatus < 0x80) {
+                if (!prevLength) return Status::InvalidEvent;
+                if (static_cast<size_t>(end - cursor) < prevLength - 1) return Status::Truncated;
+                status = append(time, prevStatus, cursor, prevLength - 1);
+                cursor += prevLength - 1;
+            }
+            // Meta message, does not affect running status
+            else if (curStatus == 0xFF) {
+                if (end - cursor < 2) return Status::Truncated;
+                const uint8_t *begin = cursor + 1;
+                cursor += 2;
+                uint32_t length = 0;
+                if (!read_variable_length(cursor, end, length)) return Status::Truncated;
+                if (static_cast<size_t>(end - cursor) < length) return Status::Truncated;
+                cursor += length;
+                status = append(time, curStatus, begin, cursor - begin);
+                if (status == Status::Ok && begin[0] == static_cast<uint8_t>(message::MetaType::EndOfTrack)) break;
+            }
+            // SysEx message or SysEx escape
+            else if (curStatus == 0xF0 || curStatus == 0xF7) {
+                const uint8_t *begin = cursor + 1;
+                cursor += 1;
+                uint32_t length = 0;
+                if (!read_variable_length(cursor, end, length)) return Status::Truncated;
+                if (static_cast<size_t>(end - cursor) < length) return Status::Truncated;
+                cursor += length;
+                status = append(time, curStatus, begin, cursor - begin);
+                prevLength = 0;
+            }
+            // Channel message or system common message
+            else {
+                const size_t length = message::status_to_length(curStatus);
+                if (!length) return Status::InvalidEvent;
+                if (static_cast<size_t>(end - cursor) < length) return Status::Truncated;
+                status = append(time, curStatus, cursor + 1, length - 1);
+                cursor += length;
+                prevStatus = curStatus;
+                prevLength = length;
+            }
+            if (status != Status::Ok) return status;
+        }
+        return Status::Ok;
+    };
+
+public:
+    FixedMidiFile(Event *events, const size_t eventCapacity,
+                  uint8_t *payload, const size_t payloadCapacity,
+                  TrackEntry *tracks, const size_t trackCapacity):
+        events(events), eventCapacity(eventCapacity),
+        payload(payload), payloadCapacity(payloadCapacity),
+        tracks(tracks), trackCapacity(trackCapacity) {};
+
+    // the arrays are not copied
+    FixedMidiFile(const FixedMidiFile &) = delete;
+    FixedMidiFile &operator=(const FixedMidiFile &) = delete;
+
+    // Parse a midi file, replacing the previous content. Nothing refers to data afterwards.
+    Status parse(const uint8_t *data, const size_t size) {
+        this->clear();
+        if (size < 14 || std::memcmp(data, "MThd", 4) != 0 || utils::read_msb_bytes(data + 4, 4) != 6)
+            return Status::InvalidHeader;
+        const uint16_t declaredTrackNum = static_cast<uint16_t>(utils::read_msb_bytes(data + 10, 2));
+        if (declaredTrackNum > trackCapacity) return Status::TooManyTracks;
+
+        const uint8_t *cursor = data + 14;
+        const uint8_t *end = data + size;
+        Status status = Status::Ok;
+        while (trackNum < declaredTrackNum && status == Status::Ok) {
+            if (end - cursor < 8) {
+                status = Status::Truncated;
+                break;
+            }
+            const size_t chunkLen = utils::read_msb_bytes(cursor + 4, 4);
+            if (static_cast<size_t>(end - cursor - 8) < chunkLen) {
+                status = Status::Truncated;
+                break;
+            }
+            // Skip unknown chunk
+            if (std::memcmp(cursor, "MTrk", 4) == 0) {
+                const size_t firstEvent = eventNum;
+                status = parse_track(cursor + 8, cursor + 8 + chunkLen);
+                tracks[trackNum++] = {static_cast<uint32_t>(firstEvent), static_cast<uint32_t>(eventNum - firstEvent)};
+            }
+            cursor += 8 + chunkLen;
+        }
+
+        if (status != Status::Ok) {
+            this->clear();
+            return status;
+        }
+        format = static_cast<uint16_t>(utils::read_msb_bytes(data + 8, 2));
+        division = static_cast<uint16_t>(utils::read_msb_bytes(data + 12, 2));
+        return Status::Ok;
+    };
+
+    void clear() {
+        eventNum = 0;
+        payloadSize = 0;
+        trackNum = 0;
+        format = 0;
+        division = 0;
+    };
+
+    [[nodiscard]] uint16_t get_format() const { return format; };
+
+    [[nodiscard]] uint16_t get_division_type() const { return division >> 15; };
+
+    // Division type 1 have no tpq, 0 is returned.
+    [[nodiscard]] uint16_t get_tick_per_quarter() const { return get_division_type() ? 0 : division; };
+
+    // Division type 0 have no tps, 0 is returned.
+    [[nodiscard]] uint32_t get_tick_per_second() const {
+        if (!get_division_type()) return 0;
+        const auto framePerSecond = static_cast<uint32_t>(-static_cast<int8_t>(division >> 8));
+        return framePerSecond * (division & 0xFF);
+    };
+
+    [[nodiscard]] size_t track_num() const { return trackNum; };
+
+    [[nodiscard]] size_t event_num() const { return eventNum; };
+
+    // bytes used in the payload pool
+    [[nodiscard]] size_t payload_size() const { return payloadSize; };
+
+    [[nodiscard]] TrackView track(const size_t index) const {
+        return {events + tracks[index].firstEvent, tracks[index].eventNum, payload};
+    };
+};
+
+template<size_t EventCapacity, size_t PayloadCapacity, size_t TrackCapacity>
+struct FixedStorage {
+    std::array<Event, EventCapacity> eventStorage;
+    std::array<uint8_t, PayloadCapacity> payloadStorage;
+    std::array<TrackEntry, TrackCapacity> trackStorage;
+};
+
+// FixedMidiFile owning its arrays, meant to be a static or global object, e.g.
+//
+//     static fixed::StaticMidiFile<4096, 16384, 16> song;
+//     if (song.parse(data, size) != fixed::Status::Ok) ...
+template<size_t EventCapacity, size_t PayloadCapacity, size_t TrackCapacity>
+class StaticMidiFile: private FixedStorage<EventCapacity, PayloadCapacity, TrackCapacity>, public FixedMidiFile {
+    typedef FixedStorage<EventCapacity, PayloadCapacity, TrackCapacity> Storage;
+
+public:
+    StaticMidiFile(): FixedMidiFile(Storage::eventStorage.data(), EventCapacity,
+                                    Storage::payloadStorage.data(), PayloadCapacity,
+                                    Storage::trackStorage.data(), TrackCapacity) {};
+};
+
+// Events of all tracks of a FixedMidiFile in time order, with their time in microseconds
+// following the SetTempo events. Events at the same tick come in track order. A file with
+// more than TrackCapacity tracks is not played, see status().
+template<size_t TrackCapacity>
+class Player {
+    const FixedMidiFile &file;
+    std::array<uint32_t, TrackCapacity> positions{};
+    uint32_t tempo = 500000;
+    message::Time baseTick = 0;
+    uint64_t baseMicros = 0;
+
+public:
+    explicit Player(const FixedMidiFile &file): file(file) {};
+
+    [[nodiscard]] Status status() const {
+        if (file.track_num() > TrackCapacity) return Status::TooManyTracks;
+        if (file.get_division_type() ? !file.get_tick_per_second() : !file.get_tick_per_quarter())
+            return Status::InvalidHeader;
+        return Status::Ok;
+    };
+
+    // Next event and its time in microseconds, false after the last event.
+    bool next(MessageView &event, uint64_t &micros) {
+        if (this->status() != Status::Ok) return false;
+        size_t best = TrackCapacity;
+        message::Time bestTime = 0;
+        for (size_t t = 0; t < file.track_num(); ++t) {
+            const TrackView track = file.track(t);
+            if (positions[t] == track.message_num()) continue;
+            const message::Time time = track.message(positions[t]).get_time();
+            if (best == TrackCapacity || time < bestTime) {
+                best = t;
+                bestTime = time;
+            }
+        }
+        if (best == TrackCapacity) return false;
+        event = file.track(best).message(positions[best]++);
+
+        if (file.get_division_type()) {
+            micros = static_cast<uint64_t>(bestTime) * 1000000 / file.get_tick_per_second();
+            return true;
+        }
+        micros = baseMicros + static_cast<uint64_t>(bestTime - baseTick) * tempo / file.get_tick_per_quarter();
+        if (event.get_type() == message::MessageType::Meta &&
+            event.get_meta_type() == message::MetaType::SetTempo && event.meta_size() >= 3) {
+            tempo = event.get_tempo();
+            baseTick = bestTime;
+            baseMicros = micros;
+        }
+        return true;
+    };
+
+    void rewind() {
+        positions.fill(0);
+        tempo = 500000;
+        baseTick = 0;
+        baseMicros = 0;
+    };
+};
+
+}
+
+}
+
+#endif //MINIMIDI_FIXED_HPP
@@ -0,0 +1,264 @@
+#ifndef MINIMIDI_FROZEN_HPP
+#define MINIMIDI_FROZEN_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<cstring>
+#include<memory>
+#include<new>
+#include<iterator>
+#include<stdexcept>
+#include"Core.hpp"
+
+namespace minimidi {
+
+namespace file {
+
+namespace frozen {
+
+typedef struct {
+    message::Time time;
+    // offset of the data bytes in the payload, the size is up to the offset of the next entry
+    uint32_t offset;
+    uint8_t statusByte;
+} MessageEntry;
+
+typedef struct {
+    uint32_t firstMessage;
+    uint32_t messageNum;
+} TrackEntry;
+
+typedef struct {
+    MidiFormat format;
+    uint16_t division;
+    uint32_t trackNum;
+    uint32_t messageNum;
+    size_t payloadSize;
+} Header;
+
+constexpr size_t align_up(const size_t size, const size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+};
+
+// Non-owning view of a message in a FrozenMidiFile.
+class MessageView {
+    const MessageEntry *entry;
+    const uint8_t *payload;
+
+public:
+    MessageView(const MessageEntry *entry, const uint8_t *payload): entry(entry), payload(payload) {};
+
+    [[nodiscard]] message::Time get_time() const { return entry->time; };
+
+    [[nodiscard]] uint8_t get_status_byte() const { return entry->statusByte; };
+
+    [[nodiscard]] const uint8_t *data() const { return payload + entry->offset; };
+
+    [[nodiscard]] size_t size() const { return (entry + 1)->offset - entry->offset; };
+
+    [[nodiscard]] message::MessageType get_type() const { return message::status_to_message_type(entry->statusByte); };
+
+    [[nodiscard]] uint8_t get_channel() const { return entry->statusByte & 0x0F; };
+
+    [[nodiscard]] uint8_t get_pitch() const { return data()[0]; };
+
+    [[nodiscard]] uint8_t get_velocity() const { return data()[1]; };
+
+    [[nodiscard]] uint8_t get_control_number() const { return data()[0]; };
+
+    [[nodiscard]] uint8_t get_control_value() const { return data()[1]; };
+
+    [[nodiscard]] uint8_t get_program() const { return data()[0]; };
+
+    [[nodiscard]] message::MetaType get_meta_type() const { return message::status_to_meta_type(data()[0]); };
+
+    // Copy into a mutable Message.
+    [[nodiscard]] message::Message to_message() const {
+        return {entry->time, entry->statusByte, data(), size()};
+    };
+};
+
+// Non-owning view of a track in a FrozenMidiFile.
+class TrackView {
+    const MessageEntry *entries;
+    size_t messageNum;
+    const uint8_t *payload;
+
+public:
+    class Iterator {
+        const MessageEntry *entry;
+        const uint8_t *payload;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef MessageView value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef MessageView reference;
+
+        Iterator(const MessageEntry *entry, const uint8_t *payload): entry(entry), payload(payload) {};
+
+        MessageView operator*() const { return {entry, payload}; };
+
+        Iterator &operator++() {
+            ++entry;
+            return *this;
+        };
+
+        Iterator operator++(int) {
+            Iterator prev = *this;
+            ++entry;
+            return prev;
+        };
+
+        bool operator==(const Iterator &other) const { return entry == other.entry; };
+
+        bool operator!=(const Iterator &other) const { return entry != other.entry; };
+    };
+
+    TrackView(const MessageEntry *entries, const size_t messageNum, const uint8_t *payload):
+        entries(entries), messageNum(messageNum), payload(payload) {};
+
+    [[nodiscard]] MessageView message(const size_t index) const {
+        return {entries + index, payload};
+    };
+
+    [[nodiscard]] size_t message_num() const {
+        return this->messageNum;
+    };
+
+    [[nodiscard]] Iterator begin() const { return {entries, payload}; };
+
+    [[nodiscard]] Iterator end() const { return {entries + messageNum, payload}; };
+
+    // Copy into a mutable Track.
+    [[nodiscard]] track::Track to_track() const {
+        message::Messages messages;
+        messages.reserve(messageNum);
+        for (const auto &msg: *this) messages.emplace_back(msg.to_message());
+        return track::Track(std::move(messages));
+    };
+};
+
+}
+
+// Immutable MidiFile in a single allocation: header, track table, message table and all
+// message data bytes. Copies share the allocation through reference counting, and reading
+// needs no synchronization since nothing can modify it. Views handed out stay valid as
+// long as one copy of the FrozenMidiFile is alive. A default constructed one is empty
+// and reports the defaults of MidiFile().
+class FrozenMidiFile {
+    std::shared_ptr<const uint8_t[]> storage;
+    const frozen::Header *header = nullptr;
+    const frozen::TrackEntry *trackEntries = nullptr;
+    const frozen::MessageEntry *messageEntries = nullptr;
+    const uint8_t *payload = nullptr;
+
+    void locate() {
+        const uint8_t *base = storage.get();
+        header = reinterpret_cast<const frozen::Header *>(base);
+        size_t offset = frozen::align_up(sizeof(frozen::Header), alignof(frozen::TrackEntry));
+        trackEntries = reinterpret_cast<const frozen::TrackEntry *>(base + offset);
+        offset = frozen::align_up(offset + header->trackNum * sizeof(frozen::TrackEntry), alignof(frozen::MessageEntry));
+        messageEntries = reinterpret_cast<const frozen::MessageEntry *>(base + offset);
+        // one sentinel entry past the last message
+        payload = base + offset + (header->messageNum + 1) * sizeof(frozen::MessageEntry);
+    };
+
+public:
+    FrozenMidiFile() = default;
+
+    explicit FrozenMidiFile(const MidiFile &midiFile) {
+        size_t messageNum = 0, payloadSize = 0;
+        for (const auto &track: midiFile.tracks) {
+            messageNum += track.message_num();
+            for (const auto &msg: track.messages) {
+                payloadSize += msg.is_interned() ? msg.materialized().get_data().size() : msg.get_data().size();
+            }
+        }
+        if (messageNum >= UINT32_MAX || payloadSize >= UINT32_MAX) {
+            throw std::length_error("MiniMidi: MidiFile is too large to freeze!");
+        }
+
+        const size_t trackNum = midiFile.track_num();
+        const size_t trackOffset = frozen::align_up(sizeof(frozen::Header), alignof(frozen::TrackEntry));
+        const size_t messageOffset = frozen::align_up(trackOffset + trackNum * sizeof(frozen::TrackEntry),
+            alignof(frozen::MessageEntry));
+        const size_t payloadOffset = messageOffset + (messageNum + 1) * sizeof(frozen::MessageEntry);
+
+        uint8_t *base = new uint8_t[payloadOffset + payloadSize];
+        storage = std::shared_ptr<const uint8_t[]>(base);
+
+        new (base) frozen::Header{midiFile.format,
+            static_cast<uint16_t>((midiFile.divisionType << 15) | midiFile.ticksPerQuarter),
+            static_cast<uint32_t>(trackNum), static_cast<uint32_t>(messageNum), payloadSize};
+
+        uint32_t msgIdx = 0, dataOffset = 0;
+        for (size_t t = 0; t < trackNum; ++t) {
+            const auto &messages = midiFile.tracks[t].messages;
+            new (base + trackOffset + t * sizeof(frozen::TrackEntry))
+                frozen::TrackEntry{msgIdx, static_cast<uint32_t>(messages.size())};
+            for (const auto &original: messages) {
+                // interned text is stored as the text itself
+                const message::Message plain = original.is_interned() ? original.materialized() : message::Message();
+                const auto &data = original.is_interned() ? plain.get_data() : original.get_data();
+                new (base + messageOffset + msgIdx * sizeof(frozen::MessageEntry))
+                    frozen::MessageEntry{original.get_time(), dataOffset, original.get_status_byte()};
+                std::memcpy(base + payloadOffset + dataOffset, data.data(), data.size());
+                dataOffset += static_cast<uint32_t>(data.size());
+                ++msgIdx;
+            }
+        }
+        new (base + messageOffset + msgIdx * sizeof(frozen::MessageEntry))
+            frozen::MessageEntry{0, dataOffset, 0};
+
+        this->locate();
+    };
+
+    [[nodiscard]] MidiFormat get_format() const {
+        return header ? header->format : MidiFormat::MultiTrack;
+    };
+
+    [[nodiscard]] uint16_t get_division_type() const {
+        return header ? header->division >> 15 : 0;
+    };
+
+    [[nodiscard]] uint16_t get_tick_per_quarter() const {
+        return header ? header->division & 0x7FFF : 960;
+    };
+
+    [[nodiscard]] size_t track_num() const {
+        return header ? header->trackNum : 0;
+    };
+
+    [[nodiscard]] size_t message_num() const {
+        return header ? header->messageNum : 0;
+    };
+
+    [[nodiscard]] frozen::TrackView track(const size_t index) const {
+        if (!header) throw std::out_of_range("MiniMidi: Track index out of range of an empty FrozenMidiFile!");
+        const frozen::TrackEntry &entry = trackEntries[index];
+        return {messageEntries + entry.firstMessage, entry.messageNum, payload};
+    };
+
+    // Bytes of the shared allocation.
+    [[nodiscard]] size_t storage_size() const {
+        return header ? (payload - storage.get()) + header->payloadSize : 0;
+    };
+
+    // Copy into a mutable MidiFile.
+    [[nodiscard]] MidiFile thaw() const {
+        if (!header) return MidiFile();
+        const uint16_t division = header->division;
+        MidiFile midiFile(header->format, division >> 15, division & 0x7FFF);
+        midiFile.tracks.reserve(header->trackNum);
+        for (size_t t = 0; t < header->trackNum; ++t) midiFile.tracks.emplace_back(track(t).to_track());
+        return midiFile;
+    };
+};
+
+}
+
+}
+
+#endif //MINIMIDI_FROZEN_HPP
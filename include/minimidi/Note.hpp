@@ -0,0 +1,228 @@
+#ifndef MINIMIDI_NOTE_HPP
+#define MINIMIDI_NOTE_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<vector>
+#include<algorithm>
+#include<numeric>
+#include<queue>
+#include<functional>
+#include<iterator>
+#include"Core.hpp"
+#include"Filter.hpp"
+
+namespace minimidi {
+
+namespace note {
+
+typedef struct {
+    message::Time onset;
+    message::Time duration;
+    uint8_t pitch;
+    uint8_t velocity;
+    uint8_t channel;
+    uint16_t track;
+} Note;
+
+typedef std::vector<Note> NoteList;
+
+inline bool is_note_on(const message::Message &msg) {
+    return msg.get_type() == message::MessageType::NoteOn && msg.get_velocity();
+};
+
+inline bool is_note_off(const message::Message &msg) {
+    return msg.get_type() == message::MessageType::NoteOff ||
+        (msg.get_type() == message::MessageType::NoteOn && !msg.get_velocity());
+};
+
+// Pair note ons and note offs of a track in a single sweep.
+// on(onset, channel, pitch, velocity) is called for every note on in time order and returns
+// a slot id, off(slot, offset) is called once the note is closed.
+// Overlapping notes of the same key are closed first in, first out.
+// Notes never closed end at the last tick of the track.
+template<typename OnFunc, typename OffFunc>
+void pair_notes(const track::Track &track, OnFunc &&on, OffFunc &&off) {
+    // slots of sounding notes per (channel, pitch)
+    std::vector<std::vector<size_t>> sounding(16 * 128);
+    message::Time lastTick = 0;
+
+    for (const auto &msg: track.messages) {
+        lastTick = std::max(lastTick, msg.get_time());
+        if (is_note_on(msg)) {
+            sounding[msg.get_channel() * 128 + (msg.get_pitch() & 0x7F)].push_back(
+                on(msg.get_time(), msg.get_channel(), static_cast<uint8_t>(msg.get_pitch() & 0x7F), msg.get_velocity()));
+        } else if (is_note_off(msg)) {
+            auto &slots = sounding[msg.get_channel() * 128 + (msg.get_pitch() & 0x7F)];
+            if (slots.empty()) continue;
+            off(slots.front(), msg.get_time());
+            slots.erase(slots.begin());
+        }
+    }
+
+    for (const auto &slots: sounding) {
+        for (const size_t slot: slots) off(slot, lastTick);
+    }
+};
+
+// Notes of a track in onset order.
+inline void extract_notes(const track::Track &track, const uint16_t trackIdx, NoteList &notes) {
+    pair_notes(track,
+        [&notes, trackIdx](const message::Time onset, const uint8_t channel, const uint8_t pitch, const uint8_t velocity) {
+            notes.push_back({onset, 0, pitch, velocity, channel, trackIdx});
+            return notes.size() - 1;
+        },
+        [&notes](const size_t slot, const message::Time offset) {
+            notes[slot].duration = offset - notes[slot].onset;
+        });
+};
+
+// Notes of all tracks of a file, sorted by onset.
+inline NoteList extract_notes(const file::MidiFile &midiFile) {
+    NoteList notes;
+    for (size_t t = 0; t < midiFile.track_num(); ++t)
+        extract_notes(midiFile.tracks[t], static_cast<uint16_t>(t), notes);
+    std::stable_sort(notes.begin(), notes.end(),
+        [](const Note &a, const Note &b) { return a.onset < b.onset; });
+    return notes;
+};
+
+// Struct of arrays note container, one column per field.
+class Notes {
+public:
+    std::vector<message::Time> onsets;
+    std::vector<message::Time> durations;
+    std::vector<uint8_t> pitches;
+    std::vector<uint8_t> velocities;
+    std::vector<uint8_t> channels;
+    std::vector<uint16_t> tracks;
+
+    Notes() = default;
+
+    // Notes of a track, already in onset order.
+    explicit Notes(const track::Track &track, const uint16_t trackIdx = 0) {
+        this->append(track, trackIdx);
+    };
+
+    void append(const track::Track &track, const uint16_t trackIdx) {
+        this->reserve(this->size() + track.message_num() / 2);
+        pair_notes(track,
+            [this, trackIdx](const message::Time onset, const uint8_t channel, const uint8_t pitch, const uint8_t velocity) {
+                this->push_back(onset, 0, pitch, velocity, channel, trackIdx);
+                return this->size() - 1;
+            },
+            [this](const size_t slot, const message::Time offset) {
+                durations[slot] = offset - onsets[slot];
+            });
+    };
+
+    void reserve(const size_t num) {
+        onsets.reserve(num);
+        durations.reserve(num);
+        pitches.reserve(num);
+        velocities.reserve(num);
+        channels.reserve(num);
+        tracks.reserve(num);
+    };
+
+    void push_back(const message::Time onset, const message::Time duration, const uint8_t pitch,
+                const uint8_t velocity, const uint8_t channel, const uint16_t track) {
+        onsets.push_back(onset);
+        durations.push_back(duration);
+        pitches.push_back(pitch);
+        velocities.push_back(velocity);
+        channels.push_back(channel);
+        tracks.push_back(track);
+    };
+
+    void push_back(const Note &note) {
+        this->push_back(note.onset, note.duration, note.pitch, note.velocity, note.channel, note.track);
+    };
+
+    void clear() {
+        onsets.clear();
+        durations.clear();
+        pitches.clear();
+        velocities.clear();
+        channels.clear();
+        tracks.clear();
+    };
+
+    [[nodiscard]] size_t size() const {
+        return this->onsets.size();
+    };
+
+    [[nodiscard]] bool empty() const {
+        return this->onsets.empty();
+    };
+
+    [[nodiscard]] Note note(const size_t idx) const {
+        return {onsets[idx], durations[idx], pitches[idx], velocities[idx], channels[idx], tracks[idx]};
+    };
+
+    [[nodiscard]] bool is_sorted() const {
+        return std::is_sorted(onsets.begin(), onsets.end());
+    };
+
+    // Indices of notes in onset order, without sorting when already sorted.
+    [[nodiscard]] std::vector<size_t> onset_order() const {
+        std::vector<size_t> order(this->size());
+        std::iota(order.begin(), order.end(), 0);
+        if (!this->is_sorted()) {
+            std::stable_sort(order.begin(), order.end(),
+                [this](const size_t a, const size_t b) { return onsets[a] < onsets[b]; });
+        }
+        return order;
+    };
+
+    // Note ons and note offs (of one track, or of all tracks for -1) in time order.
+    // Note ons come in onset order and note offs are merged in through a min-heap of pending
+    // offsets, so only the current polyphony is ever ordered. At the same tick, note offs
+    // come before note ons.
+    [[nodiscard]] message::Messages to_messages(const int32_t trackIdx = -1) const {
+        // (offset, note index)
+        typedef std::pair<message::Time, size_t> Pending;
+        std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+
+        message::Messages messages;
+        messages.reserve(this->size() * 2);
+        const auto emit_off = [&]() {
+            const size_t i = pending.top().second;
+            messages.emplace_back(message::Message::NoteOff(pending.top().first, channels[i], pitches[i], 0));
+            pending.pop();
+        };
+
+        for (const size_t i: this->onset_order()) {
+            if (trackIdx >= 0 && tracks[i] != trackIdx) continue;
+            while (!pending.empty() && pending.top().first <= onsets[i]) emit_off();
+            messages.emplace_back(message::Message::NoteOn(onsets[i], channels[i], pitches[i], velocities[i]));
+            pending.emplace(onsets[i] + durations[i], i);
+        }
+        while (!pending.empty()) emit_off();
+
+        return messages;
+    };
+
+    // A track of the notes merged with the non-note messages of `others` (time sorted).
+    // At the same tick, messages from `others` come first.
+    [[nodiscard]] track::Track to_track(const track::Track &others = track::Track(), const int32_t trackIdx = -1) const {
+        const message::Messages noteMessages = this->to_messages(trackIdx);
+        const message::Messages otherMessages = message::filter_message(others.messages,
+            [](const message::Message &msg) { return !is_note_on(msg) && !is_note_off(msg); });
+
+        message::Messages messages;
+        messages.reserve(noteMessages.size() + otherMessages.size());
+        std::merge(otherMessages.begin(), otherMessages.end(),
+            noteMessages.begin(), noteMessages.end(),
+            std::back_inserter(messages),
+            [](const message::Message &a, const message::Message &b) { return a.get_time() < b.get_time(); });
+
+        return track::Track(std::move(messages));
+    };
+};
+
+}
+
+}
+
+#endif //MINIMIDI_NOTE_HPP
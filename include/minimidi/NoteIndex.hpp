@@ -0,0 +1,160 @@
+#ifndef MINIMIDI_NOTE_INDEX_HPP
+#define MINIMIDI_NOTE_INDEX_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<vector>
+#include<algorithm>
+#include"Core.hpp"
+#include"Note.hpp"
+
+namespace minimidi {
+
+namespace note {
+
+typedef struct {
+    // bit i for channel i
+    uint16_t channels;
+    uint8_t minPitch;
+    uint8_t maxPitch;
+    // -1 for all tracks
+    int32_t track;
+} NoteFilter;
+
+constexpr NoteFilter ALL_NOTES = {0xFFFF, 0, 127, -1};
+
+inline bool match(const NoteFilter &filter, const Note &note) {
+    return ((filter.channels >> note.channel) & 1) &&
+        note.pitch >= filter.minPitch && note.pitch <= filter.maxPitch &&
+        (filter.track < 0 || filter.track == note.track);
+};
+
+// Immutable interval index over notes, each note covering [onset, onset + duration).
+// The notes are sorted by onset and laid out as an implicit balanced binary tree in
+// the sorted array (node i is on the level of its number of trailing 1 bits), every
+// node augmented with the max end of its subtree. Queries are O(log n + k);
+// filters are applied on the k overlapping notes.
+class NoteIndex {
+    std::vector<Note> notes;
+    // hot columns used by the tree walk, in the same order as notes
+    std::vector<message::Time> begins;
+    std::vector<message::Time> ends;
+    std::vector<message::Time> maxEnds;
+    int maxLevel = -1;
+
+    void build() {
+        std::stable_sort(notes.begin(), notes.end(),
+            [](const Note &a, const Note &b) { return a.onset < b.onset; });
+
+        const size_t n = notes.size();
+        begins.resize(n);
+        ends.resize(n);
+        maxEnds.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            begins[i] = notes[i].onset;
+            ends[i] = notes[i].onset + notes[i].duration;
+        }
+        if (!n) return;
+
+        // leaves
+        size_t lastIdx = 0;
+        message::Time last = 0;
+        for (size_t i = 0; i < n; i += 2) {
+            lastIdx = i;
+            maxEnds[i] = last = ends[i];
+        }
+        // internal nodes, level by level
+        int k = 1;
+        for (; (static_cast<size_t>(1) << k) <= n; ++k) {
+            const size_t x = static_cast<size_t>(1) << (k - 1);
+            const size_t step = x << 2;
+            for (size_t i = (x << 1) - 1; i < n; i += step) {
+                const message::Time leftMax = maxEnds[i - x];
+                const message::Time rightMax = i + x < n ? maxEnds[i + x] : last;
+                maxEnds[i] = std::max({ends[i], leftMax, rightMax});
+            }
+            // the max end of the rightmost node on this level, which may have missing children
+            lastIdx = (lastIdx >> k & 1) ? lastIdx - x : lastIdx + x;
+            if (lastIdx < n && maxEnds[lastIdx] > last) last = maxEnds[lastIdx];
+        }
+        maxLevel = k - 1;
+    };
+
+public:
+    NoteIndex() = default;
+
+    explicit NoteIndex(NoteList notes): notes(std::move(notes)) {
+        build();
+    };
+
+    explicit NoteIndex(const file::MidiFile &midiFile): notes(extract_notes(midiFile)) {
+        build();
+    };
+
+    // Call func(idx) for the index of every note overlapping [begin, end) and matching the filter.
+    template<typename Func>
+    void for_each_overlap(const message::Time begin, const message::Time end, Func &&func,
+                        const NoteFilter &filter = ALL_NOTES) const {
+        if (maxLevel < 0 || begin >= end) return;
+
+        typedef struct {
+            int level;
+            size_t idx;
+            bool visited;
+        } StackItem;
+        StackItem stack[128];
+        const size_t n = notes.size();
+        int top = 0;
+        stack[top++] = {maxLevel, (static_cast<size_t>(1) << maxLevel) - 1, false};
+
+        const auto report = [&](const size_t i) {
+            if (begin < ends[i] && match(filter, notes[i])) func(i);
+        };
+
+        while (top) {
+            const StackItem item = stack[--top];
+            if (item.level <= 3) {
+                // small subtree, scan it linearly
+                const size_t first = item.idx >> item.level << item.level;
+                const size_t last = std::min(n, first + (static_cast<size_t>(1) << (item.level + 1)) - 1);
+                for (size_t i = first; i < last && begins[i] < end; ++i) report(i);
+            } else if (!item.visited) {
+                // visit the left child first, come back to this node later
+                const size_t left = item.idx - (static_cast<size_t>(1) << (item.level - 1));
+                stack[top++] = {item.level, item.idx, true};
+                if (left >= n || maxEnds[left] > begin)
+                    stack[top++] = {item.level - 1, left, false};
+            } else if (item.idx < n && begins[item.idx] < end) {
+                report(item.idx);
+                stack[top++] = {item.level - 1, item.idx + (static_cast<size_t>(1) << (item.level - 1)), false};
+            }
+        }
+    };
+
+    // Indices of notes sounding during [begin, end), in no particular order.
+    [[nodiscard]] std::vector<size_t> overlap(const message::Time begin, const message::Time end,
+                                            const NoteFilter &filter = ALL_NOTES) const {
+        std::vector<size_t> result;
+        for_each_overlap(begin, end, [&result](const size_t i) { result.push_back(i); }, filter);
+        return result;
+    };
+
+    // Indices of notes sounding at tick.
+    [[nodiscard]] std::vector<size_t> stab(const message::Time tick, const NoteFilter &filter = ALL_NOTES) const {
+        return overlap(tick, tick + 1, filter);
+    };
+
+    [[nodiscard]] const Note &note(const size_t idx) const {
+        return this->notes[idx];
+    };
+
+    [[nodiscard]] size_t note_num() const {
+        return this->notes.size();
+    };
+};
+
+}
+
+}
+
+#endif //MINIMIDI_NOTE_INDEX_HPP
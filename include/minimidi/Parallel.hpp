@@ -0,0 +1,127 @@
+#ifndef MINIMIDI_PARALLEL_HPP
+#define MINIMIDI_PARALLEL_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<vector>
+#include<thread>
+#include<atomic>
+#include<mutex>
+#include<condition_variable>
+#include<algorithm>
+#include"Core.hpp"
+#include"Filter.hpp"
+
+namespace minimidi {
+
+namespace parallel {
+
+inline size_t default_thread_num() {
+    const size_t num = std::thread::hardware_concurrency();
+    return num ? num : 1;
+};
+
+// Run func(chunkIdx, begin, end) over [0, size) split into chunkNum contiguous chunks,
+// the calling thread takes the first chunk.
+template<typename Func>
+void for_each_chunk(const size_t size, const size_t chunkNum, Func &&func) {
+    const size_t chunkSize = (size + chunkNum - 1) / chunkNum;
+    std::vector<std::thread> workers;
+    workers.reserve(chunkNum - 1);
+    for (size_t c = 1; c < chunkNum; ++c) {
+        const size_t begin = std::min(size, c * chunkSize);
+        const size_t end = std::min(size, begin + chunkSize);
+        workers.emplace_back([&func, c, begin, end]() { func(c, begin, end); });
+    }
+    func(static_cast<size_t>(0), static_cast<size_t>(0), std::min(size, chunkSize));
+    for (auto &worker: workers) worker.join();
+};
+
+// Run func(idx, workerIdx) for every idx in [0, size) on a pool of threadNum workers,
+// each pulling the next index when it is done with the previous one.
+template<typename Func>
+void for_each_index(const size_t size, size_t threadNum, Func &&func) {
+    if (!threadNum) threadNum = default_thread_num();
+    threadNum = std::max<size_t>(1, std::min(threadNum, size));
+
+    std::atomic<size_t> next{0};
+    const auto work = [&func, &next, size](const size_t worker) {
+        for (size_t idx = next++; idx < size; idx = next++) func(idx, worker);
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threadNum - 1);
+    for (size_t w = 1; w < threadNum; ++w) workers.emplace_back(work, w);
+    work(0);
+    for (auto &worker: workers) worker.join();
+};
+
+// Counting budget (e.g. bytes of memory in flight) shared by worker threads.
+// acquire blocks until the amount fits, a request larger than the whole budget
+// is granted once nothing else is in flight.
+class Budget {
+    const size_t capacity;
+    size_t used = 0;
+    std::mutex mutex;
+    std::condition_variable released;
+
+public:
+    explicit Budget(const size_t capacity): capacity(capacity) {};
+
+    void acquire(const size_t amount) {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [&]() { return used == 0 || used + amount <= capacity; });
+        used += amount;
+    };
+
+    void release(const size_t amount) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            used -= amount;
+        }
+        released.notify_all();
+    };
+};
+
+// Parallel filter_message for very large tracks. The predicate is evaluated once per message
+// on disjoint chunks concurrently, then every chunk is compacted into its offset of the result.
+// filter must be safe to call from several threads. Fall back to the sequential version when
+// the input is smaller than two chunks of minChunk messages.
+template<typename Pred>
+message::Messages filter_message(const message::Messages &messages,
+                                const Pred &filter,
+                                size_t threadNum = 0,
+                                const size_t minChunk = 1 << 16) {
+    if (!threadNum) threadNum = default_thread_num();
+    const size_t chunkNum = std::min(threadNum, messages.size() / std::max<size_t>(minChunk, 1));
+    if (chunkNum <= 1) return message::filter_message(messages, filter);
+
+    // 1. evaluate the predicate and count kept messages per chunk
+    std::vector<uint8_t> keep(messages.size());
+    std::vector<size_t> offsets(chunkNum + 1, 0);
+    for_each_chunk(messages.size(), chunkNum, [&](const size_t c, const size_t begin, const size_t end) {
+        size_t count = 0;
+        for (size_t i = begin; i < end; ++i) {
+            keep[i] = static_cast<uint8_t>(static_cast<bool>(filter(messages[i])));
+            count += keep[i];
+        }
+        offsets[c + 1] = count;
+    });
+    for (size_t c = 0; c < chunkNum; ++c) offsets[c + 1] += offsets[c];
+
+    // 2. compact every chunk into its own range of the result
+    message::Messages new_messages(offsets[chunkNum]);
+    for_each_chunk(messages.size(), chunkNum, [&](const size_t c, const size_t begin, const size_t end) {
+        size_t out = offsets[c];
+        for (size_t i = begin; i < end; ++i) {
+            if (keep[i]) new_messages[out++] = messages[i];
+        }
+    });
+
+    return new_messages;
+};
+
+}
+
+}
+
+#endif //MINIMIDI_PARALLEL_HPP
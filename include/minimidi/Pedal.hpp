@@ -0,0 +1,133 @@
+#ifndef MINIMIDI_PEDAL_HPP
+#define MINIMIDI_PEDAL_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<algorithm>
+#include"Core.hpp"
+#include"Note.hpp"
+
+namespace minimidi {
+
+namespace note {
+
+constexpr uint8_t SUSTAIN_CONTROL = 64;
+constexpr uint8_t SOSTENUTO_CONTROL = 66;
+
+typedef struct {
+    bool sustain;
+    bool sostenuto;
+    // controller values >= threshold mean pedal down
+    uint8_t threshold;
+} PedalOptions;
+
+constexpr PedalOptions DEFAULT_PEDAL_OPTIONS = {true, true, 64};
+
+// Notes of a track with their offsets extended by the sustain and sostenuto pedals, in onset order.
+// A single sweep over the messages with a fixed-size state per (channel, pitch):
+//   * a released key keeps sounding while the sustain pedal is down, or while the sostenuto
+//     pedal is down and the key was down when the sostenuto pedal was pressed;
+//   * re-striking a key that is still down or held by a pedal ends the previous note;
+//   * notes still sounding at the end of the track end at its last tick.
+// The messages of the track are not modified.
+inline Notes apply_pedals(const track::Track &track,
+                        const uint16_t trackIdx = 0,
+                        const PedalOptions &options = DEFAULT_PEDAL_OPTIONS) {
+    constexpr size_t NONE = SIZE_MAX;
+    typedef struct {
+        // note whose key is down
+        size_t pressed[128];
+        // note whose key is up but held by a pedal
+        size_t held[128];
+        // keys down when the sostenuto pedal was pressed
+        bool captured[128];
+        bool sustain;
+        bool sostenuto;
+    } ChannelState;
+
+    ChannelState channels[16];
+    for (auto &channel: channels) {
+        std::fill(std::begin(channel.pressed), std::end(channel.pressed), NONE);
+        std::fill(std::begin(channel.held), std::end(channel.held), NONE);
+        std::fill(std::begin(channel.captured), std::end(channel.captured), false);
+        channel.sustain = false;
+        channel.sostenuto = false;
+    }
+
+    Notes notes;
+    notes.reserve(track.message_num() / 2);
+    const auto close = [&notes](size_t &slot, const message::Time offset) {
+        if (slot == NONE) return;
+        notes.durations[slot] = offset - notes.onsets[slot];
+        slot = NONE;
+    };
+    // release the held notes no longer kept by any pedal
+    const auto release = [&close](ChannelState &channel, const message::Time time) {
+        for (uint8_t pitch = 0; pitch < 128; ++pitch) {
+            if (!channel.sustain && !(channel.sostenuto && channel.captured[pitch]))
+                close(channel.held[pitch], time);
+        }
+    };
+
+    message::Time lastTick = 0;
+    for (const auto &msg: track.messages) {
+        const message::Time time = msg.get_time();
+        lastTick = std::max(lastTick, time);
+        const message::MessageType type = msg.get_type();
+
+        if (type == message::MessageType::ControlChange) {
+            ChannelState &channel = channels[msg.get_channel()];
+            const bool down = msg.get_control_value() >= options.threshold;
+            const uint8_t number = msg.get_control_number();
+            if (options.sustain && number == SUSTAIN_CONTROL && down != channel.sustain) {
+                channel.sustain = down;
+                if (!down) release(channel, time);
+            } else if (options.sostenuto && number == SOSTENUTO_CONTROL && down != channel.sostenuto) {
+                channel.sostenuto = down;
+                if (down) {
+                    for (uint8_t pitch = 0; pitch < 128; ++pitch)
+                        channel.captured[pitch] = channel.pressed[pitch] != NONE;
+                } else {
+                    release(channel, time);
+                    std::fill(std::begin(channel.captured), std::end(channel.captured), false);
+                }
+            }
+        } else if (is_note_on(msg)) {
+            ChannelState &channel = channels[msg.get_channel()];
+            const uint8_t pitch = msg.get_pitch() & 0x7F;
+            // re-strike
+            close(channel.pressed[pitch], time);
+            close(channel.held[pitch], time);
+            channel.captured[pitch] = false;
+
+            notes.push_back(time, 0, pitch, msg.get_velocity(), msg.get_channel(), trackIdx);
+            channel.pressed[pitch] = notes.size() - 1;
+        } else if (is_note_off(msg)) {
+            ChannelState &channel = channels[msg.get_channel()];
+            const uint8_t pitch = msg.get_pitch() & 0x7F;
+            size_t &slot = channel.pressed[pitch];
+            if (slot == NONE) continue;
+            if (channel.sustain || (channel.sostenuto && channel.captured[pitch])) {
+                channel.held[pitch] = slot;
+                slot = NONE;
+            } else {
+                close(slot, time);
+            }
+        }
+    }
+
+    for (auto &channel: channels) {
+        for (uint8_t pitch = 0; pitch < 128; ++pitch) {
+            close(channel.pressed[pitch], lastTick);
+            close(channel.held[pitch], lastTick);
+        }
+    }
+
+    return notes;
+};
+
+}
+
+}
+
+#endif //MINIMIDI_PEDAL_HPP
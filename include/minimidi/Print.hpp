@@ -0,0 +1,150 @@
+#ifndef MINIMIDI_PRINT_HPP
+#define MINIMIDI_PRINT_HPP
+
+#include<iostream>
+#include<iomanip>
+#include"Core.hpp"
+
+namespace minimidi {
+
+// Here inline is used to avoid obeying the one definition rule (ODR).
+inline std::ostream &operator<<(std::ostream &out, const container::Bytes &data) {
+    out << std::hex << std::setfill('0') << "{ ";
+    for (auto &d: data) {
+        out << "0x" << std::setw(2) << static_cast<int>(d) << " ";
+    }
+    out << "}" << std::dec << std::endl;
+
+    return out;
+};
+
+namespace message {
+
+inline std::ostream &operator<<(std::ostream &out, const Message &message) {
+    out << "time=" << message.get_time() << " | [";
+    out << message.get_type_string() << "] ";
+
+    switch (message.get_type()) {
+        case (MessageType::NoteOn): {}  // the same as NoteOff
+        case (MessageType::NoteOff): {
+            out << "channel="   << static_cast<int>(message.get_channel())
+                << " pitch="    << static_cast<int>(message.get_pitch())
+                << " velocity=" << static_cast<int>(message.get_velocity());
+            break;
+        };
+        case (MessageType::ProgramChange): {
+            out << "channel="   << static_cast<int>(message.get_channel())
+                << " program="  << static_cast<int>(message.get_program());
+            break;
+        };
+        case (MessageType::ControlChange): {
+            out << "channel="           << static_cast<int>(message.get_channel())
+                << " control number="   << static_cast<int>(message.get_control_number())
+                << " control value="    << static_cast<int>(message.get_control_value());
+            break;
+        };
+        case (MessageType::Meta): {
+            out << "(" << message.get_meta_type_string() << ") ";
+            const container::ByteView value = message.get_meta_bytes();
+            // values the dedicated forms can not show exactly are printed raw, see default
+            const auto rawMeta = [&out, &message, &value]() {
+                out << static_cast<int>(message.get_meta_type_byte()) << " value=" << container::to_string(value);
+            };
+            switch (message.get_meta_type()) {
+                case (MetaType::TrackName): {
+                    out << message.get_meta_text();
+                    break;
+                };
+                case (MetaType::InstrumentName): {
+                    out << message.get_meta_text();
+                    break;
+                };
+                case (MetaType::TimeSignature): {
+                    if (value.size() != 4 || value[1] > 7) {
+                        rawMeta();
+                        break;
+                    }
+                    const TimeSignature timeSig = message.get_time_signature();
+                    out << static_cast<int>(timeSig.numerator) << "/" << static_cast<int>(timeSig.denominator);
+                    // only shown when different from what Message::TimeSignature writes
+                    if (value[2] != 0x18 || value[3] != 0x08) {
+                        out << " clocks=" << static_cast<int>(value[2])
+                            << " notated32nds=" << static_cast<int>(value[3]);
+                    }
+                    break;
+                };
+                case (MetaType::SetTempo): {
+                    if (value.size() != 3) rawMeta();
+                    else out << static_cast<int>(message.get_tempo());
+                    break;
+                };
+                case (MetaType::KeySignature): {
+                    const int8_t key = value.size() == 2 ? static_cast<int8_t>(value[0]) : 0;
+                    if (value.size() != 2 || key < -7 || key > 7 || value[1] > 1) rawMeta();
+                    else out << message.get_key_signature().to_string();
+                    break;
+                }
+                case (MetaType::EndOfTrack): {
+                    if (value.size()) rawMeta();
+                    break;
+                }
+                default: {
+                    rawMeta();
+                    break;
+                }
+            }
+            break;
+        };
+        default: {
+            out << "Status code: "  << static_cast<int>(message.get_status_byte())
+                << " length="       << message.get_data().size()
+                << " value="        << container::to_string(message.get_data());
+            break;
+        };
+    }
+
+    return out;
+};
+
+}
+
+namespace track {
+
+inline std::ostream &operator<<(std::ostream &out, const Track &track) {
+    for (int j = 0; j < track.message_num(); ++j) {
+        out << track.message(j) << std::endl;
+    }
+
+    return out;
+};
+
+}
+
+namespace file {
+
+inline std::ostream &operator<<(std::ostream &out, const MidiFile &file) {
+    out << "File format: " << file.get_format_string() << std::endl;
+    out << "Division:\n" << "    Type: " << file.get_division_type() << std::endl;
+    if (file.get_division_type()) {
+        out << "    Tick per Second: " << file.get_tick_per_second() << std::endl;
+        out << "    Frame per Second: " << file.get_frame_per_second() << std::endl;
+        out << "    Tick per Frame: " << file.ticksPerFrame << std::endl;
+    } else {
+        out << "    Tick per Quarter: " << file.get_tick_per_quarter() << std::endl;
+    }
+
+    out << std::endl;
+
+    for (int i = 0; i < file.track_num(); ++i) {
+        out << "Track " << i << ": " << std::endl;
+        out << file.track(i) << std::endl;
+    }
+
+    return out;
+};
+
+}
+
+}
+
+#endif //MINIMIDI_PRINT_HPP
@@ -0,0 +1,194 @@
+#ifndef MINIMIDI_SEGMENT_HPP
+#define MINIMIDI_SEGMENT_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<vector>
+#include<algorithm>
+#include<stdexcept>
+#include"Core.hpp"
+#include"Timing.hpp"
+#include"Chase.hpp"
+
+namespace minimidi {
+
+namespace segment {
+
+// [begin, end) in ticks
+typedef struct {
+    message::Time begin;
+    message::Time end;
+} Window;
+
+typedef struct {
+    // prepend the tempo, signatures, programs and controllers active at the window start
+    bool chaseState;
+    // drop note offs whose note on is before the window, close notes still sounding at the window end
+    bool closeNotes;
+} SegmentOptions;
+
+constexpr SegmentOptions DEFAULT_SEGMENT_OPTIONS = {true, true};
+
+inline message::Time end_tick(const file::MidiFile &midiFile) {
+    message::Time endTick = 0;
+    for (const auto &track: midiFile.tracks) {
+        for (const auto &msg: track.messages)
+            endTick = std::max(endTick, msg.get_time());
+    }
+    return endTick;
+};
+
+// Windows of `length` ticks every `hop` ticks, covering the whole file.
+inline std::vector<Window> tick_windows(const message::Time endTick, const message::Time length, const message::Time hop) {
+    if (!length || !hop) {
+        throw std::invalid_argument("MiniMidi: Window length and hop size must be positive!");
+    }
+    std::vector<Window> windows;
+    windows.reserve(endTick / hop + 1);
+    uint64_t begin = 0;
+    do {
+        windows.push_back({static_cast<message::Time>(begin),
+            static_cast<message::Time>(std::min<uint64_t>(begin + length, message::MAX_TIME))});
+        begin += hop;
+    } while (begin <= endTick);
+    return windows;
+};
+
+inline std::vector<Window> tick_windows(const file::MidiFile &midiFile, const message::Time length, const message::Time hop) {
+    return tick_windows(end_tick(midiFile), length, hop);
+};
+
+// Start ticks of all bars covering [0, endTick] and `extraBars` bars beyond,
+// see timing::MeterMap.
+inline std::vector<message::Time> bar_ticks(const file::MidiFile &midiFile, const message::Time endTick, const uint32_t extraBars = 0) {
+    const timing::MeterMap meterMap(midiFile);
+    const uint64_t barNum = static_cast<uint64_t>(meterMap.tick_to_position(endTick).bar) + 1 + extraBars;
+
+    std::vector<message::Time> bars;
+    for (uint64_t bar = 0; bar < barNum; ++bar) {
+        const message::Time tick = meterMap.bar_to_tick(static_cast<message::Time>(bar));
+        if (tick == message::MAX_TIME) break;
+        bars.push_back(tick);
+    }
+    return bars;
+};
+
+// Windows of `bars` bars every `hopBars` bars.
+inline std::vector<Window> bar_windows(const file::MidiFile &midiFile, const uint32_t bars, const uint32_t hopBars) {
+    if (!bars || !hopBars) {
+        throw std::invalid_argument("MiniMidi: Window length and hop size must be positive!");
+    }
+    const message::Time endTick = end_tick(midiFile);
+    const std::vector<message::Time> starts = bar_ticks(midiFile, endTick, bars);
+
+    std::vector<Window> windows;
+    for (size_t i = 0; i < starts.size() && starts[i] <= endTick; i += hopBars) {
+        windows.push_back({starts[i], starts[std::min(i + bars, starts.size() - 1)]});
+    }
+    return windows;
+};
+
+// Windows of `length` seconds every `hop` seconds, following the tempo map.
+inline std::vector<Window> second_windows(const file::MidiFile &midiFile, const double length, const double hop) {
+    if (!(length > 0) || !(hop > 0)) {
+        throw std::invalid_argument("MiniMidi: Window length and hop size must be positive!");
+    }
+    const timing::TempoMap tempoMap(midiFile);
+    const double endSecond = tempoMap.tick_to_second(end_tick(midiFile));
+
+    std::vector<Window> windows;
+    for (size_t i = 0; i * hop <= endSecond; ++i) {
+        const double begin = i * hop;
+        windows.push_back({tempoMap.second_to_tick(begin), tempoMap.second_to_tick(begin + length)});
+    }
+    return windows;
+};
+
+// Call `func(const Window &, const file::MidiFile &)` for every window, in a single sweep over each track.
+// Windows must be sorted by begin tick and tracks must be sorted by time, as parsed from a file.
+// The segment passed to `func` is reused between calls, copy it to keep it.
+template<typename Func>
+void for_each_segment(const file::MidiFile &midiFile,
+                    const std::vector<Window> &windows,
+                    Func &&func,
+                    const SegmentOptions &options = DEFAULT_SEGMENT_OPTIONS) {
+    for (size_t i = 1; i < windows.size(); ++i) {
+        if (windows[i].begin < windows[i - 1].begin) {
+            throw std::invalid_argument("MiniMidi: Windows must be sorted by begin tick!");
+        }
+    }
+
+    const size_t trackNum = midiFile.track_num();
+    std::vector<chase::State> states(trackNum);
+    // first message not yet applied to the state, i.e. with time >= current window begin
+    std::vector<size_t> cursors(trackNum, 0);
+    // number of note ons without note off in current window, per (channel, pitch)
+    std::vector<uint8_t> active(options.closeNotes ? 16 * 128 : 0);
+
+    file::MidiFile segment(midiFile.format, midiFile.divisionType, midiFile.ticksPerQuarter);
+    segment.tracks.resize(trackNum);
+
+    for (const auto &window: windows) {
+        for (size_t t = 0; t < trackNum; ++t) {
+            const message::Messages &messages = midiFile.tracks[t].messages;
+            message::Messages &out = segment.tracks[t].messages;
+            out.clear();
+
+            // carry the state forward to the window begin
+            size_t &cursor = cursors[t];
+            for (; cursor < messages.size() && messages[cursor].get_time() < window.begin; ++cursor)
+                states[t].apply(messages[cursor]);
+            if (options.chaseState) states[t].emit(out);
+
+            if (options.closeNotes) std::fill(active.begin(), active.end(), 0);
+
+            for (size_t i = cursor; i < messages.size() && messages[i].get_time() < window.end; ++i) {
+                const message::Message &msg = messages[i];
+                const message::MessageType type = msg.get_type();
+                if (type == message::MessageType::Meta && msg.get_meta_type() == message::MetaType::EndOfTrack)
+                    continue;
+                if (options.closeNotes &&
+                    (type == message::MessageType::NoteOn || type == message::MessageType::NoteOff)) {
+                    uint8_t &count = active[msg.get_channel() * 128 + (msg.get_pitch() & 0x7F)];
+                    if (type == message::MessageType::NoteOn && msg.get_velocity()) {
+                        if (count < UINT8_MAX) ++count;
+                    } else if (count) {
+                        --count;
+                    } else {
+                        // the note started before the window
+                        continue;
+                    }
+                }
+                out.emplace_back(msg).set_time(msg.get_time() - window.begin);
+            }
+
+            if (options.closeNotes) {
+                const message::Time length = window.end - window.begin;
+                for (size_t k = 0; k < active.size(); ++k) {
+                    for (uint8_t n = 0; n < active[k]; ++n)
+                        out.emplace_back(message::Message::NoteOff(length,
+                            static_cast<uint8_t>(k / 128), static_cast<uint8_t>(k % 128), 0));
+                }
+            }
+        }
+        func(window, static_cast<const file::MidiFile &>(segment));
+    }
+};
+
+// Materialize all windows as window-relative midi files.
+inline std::vector<file::MidiFile> segment(const file::MidiFile &midiFile,
+                                        const std::vector<Window> &windows,
+                                        const SegmentOptions &options = DEFAULT_SEGMENT_OPTIONS) {
+    std::vector<file::MidiFile> segments;
+    segments.reserve(windows.size());
+    for_each_segment(midiFile, windows, [&segments](const Window &, const file::MidiFile &seg) {
+        segments.emplace_back(seg);
+    }, options);
+    return segments;
+};
+
+}
+
+}
+
+#endif //MINIMIDI_SEGMENT_HPP
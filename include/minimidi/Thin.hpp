@@ -0,0 +1,211 @@
+#ifndef MINIMIDI_THIN_HPP
+#define MINIMIDI_THIN_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<cstdlib>
+#include<vector>
+#include<queue>
+#include<functional>
+#include<algorithm>
+#include"Core.hpp"
+
+namespace minimidi {
+
+namespace thin {
+
+typedef struct {
+    // largest difference, in 7 bit controller units, between the value of a removed event and
+    // the value held in its place; 0 only removes duplicates. Pitch bend scales it by 128.
+    uint8_t maxError;
+    bool controlChange;
+    bool pitchBend;
+    bool afterTouch;
+    // follow the streams of a file across its tracks, see thin_controllers(MidiFile &)
+    bool acrossTracks;
+} ThinOptions;
+
+constexpr ThinOptions DEFAULT_THIN_OPTIONS = {0, true, true, true, false};
+
+// Controllers whose events are not values of a curve and are always kept:
+// bank select, data entry, data increment/decrement, (N)RPN selection and channel mode messages.
+constexpr bool is_thinnable_controller(const uint8_t control) {
+    return control != 0 && control != 32 && control != 6 && control != 38 &&
+        !(control >= 96 && control <= 101) && control < 120;
+};
+
+// Values of the thinned streams of thin_controllers. Every (channel, controller),
+// (channel, key) of polyphonic aftertouch, channel pitch bend and channel aftertouch is a
+// separate stream. Events are applied in time order and identified by an id of the caller.
+class StreamState {
+    // stream layout: control change, polyphonic aftertouch, pitch bend, channel aftertouch
+    static constexpr size_t POLY = 16 * 128, BEND = POLY + 16 * 128, CHANNEL = BEND + 16, STREAM_NUM = CHANNEL + 16;
+    static constexpr int32_t UNKNOWN = INT32_MIN;
+    static constexpr size_t NONE = SIZE_MAX;
+
+    ThinOptions options;
+    // last kept value, and the removed event whose value differs from it, per stream
+    std::vector<int32_t> values;
+    std::vector<size_t> pending;
+
+    void forget(const size_t stream) {
+        values[stream] = UNKNOWN;
+        pending[stream] = NONE;
+    };
+
+public:
+    explicit StreamState(const ThinOptions &options = DEFAULT_THIN_OPTIONS):
+        options(options), values(STREAM_NUM, UNKNOWN), pending(STREAM_NUM, NONE) {};
+
+    // Whether the event is kept for now, removed events may be restored at the end.
+    bool apply(const message::Message &msg, const size_t id) {
+        const auto &data = msg.get_data();
+        size_t stream = NONE;
+        int32_t value = 0, maxError = options.maxError;
+
+        switch (msg.get_type()) {
+            case message::MessageType::ControlChange: {
+                const uint8_t control = msg.get_control_number() & 0x7F;
+                if (control == 121) {
+                    for (size_t c = 0; c < 128; ++c) forget(msg.get_channel() * 128 + c);
+                    for (size_t p = 0; p < 128; ++p) forget(POLY + msg.get_channel() * 128 + p);
+                    forget(BEND + msg.get_channel());
+                    forget(CHANNEL + msg.get_channel());
+                }
+                if (!options.controlChange || !is_thinnable_controller(control)) break;
+                stream = msg.get_channel() * 128 + control;
+                value = msg.get_control_value();
+                break;
+            };
+            case message::MessageType::PitchBend: {
+                if (!options.pitchBend) break;
+                stream = BEND + msg.get_channel();
+                value = msg.get_pitch_bend();
+                maxError *= 128;
+                break;
+            };
+            case message::MessageType::PolyphonicAfterTouch: {
+                if (!options.afterTouch) break;
+                stream = POLY + msg.get_channel() * 128 + (data[0] & 0x7F);
+                value = data[1];
+                break;
+            };
+            case message::MessageType::ChannelAfterTouch: {
+                if (!options.afterTouch) break;
+                stream = CHANNEL + msg.get_channel();
+                value = data[0];
+                break;
+            };
+            case message::MessageType::NoteOn: {
+                forget(POLY + msg.get_channel() * 128 + (msg.get_pitch() & 0x7F));
+                break;
+            };
+            default: break;
+        }
+        if (stream == NONE) return true;
+
+        if (values[stream] != UNKNOWN && std::abs(value - values[stream]) <= maxError) {
+            pending[stream] = value == values[stream] ? NONE : id;
+            return false;
+        }
+        values[stream] = value;
+        pending[stream] = NONE;
+        if (stream < POLY && (stream & 0x7F) < 32) forget(stream + 32);
+        return true;
+    };
+
+    // Removed events that must be kept after all: the last event of a stream
+    // whose removal would leave a different value held until the end.
+    [[nodiscard]] std::vector<size_t> restored() const {
+        std::vector<size_t> ids;
+        for (const size_t id: pending) {
+            if (id != NONE) ids.push_back(id);
+        }
+        return ids;
+    };
+};
+
+// Remove the messages whose flag in keep, starting at offset, is false. The order of the rest is kept.
+inline size_t remove_unkept(message::Messages &messages, const std::vector<bool> &keep, const size_t offset = 0) {
+    size_t kept = 0;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        if (!keep[offset + i]) continue;
+        if (kept != i) messages[kept] = std::move(messages[i]);
+        ++kept;
+    }
+    const size_t removed = messages.size() - kept;
+    messages.erase(messages.begin() + static_cast<long>(kept), messages.end());
+    return removed;
+};
+
+// Remove redundant controller, pitch bend and aftertouch events of a track in a single sweep,
+// returning the number of removed messages. The track must be sorted by time.
+// Receivers hold the last value until the next event, so an event is removed when it differs
+// from the last kept value of its stream (see StreamState) by at most maxError; the held value
+// then never differs from the original one by more than maxError. The last event of a stream is
+// kept whenever removing it would leave a different value held until the end of the track.
+// Sending an MSB controller (0-31) forgets the value of its LSB (32-63), reset all controllers
+// (121) forgets the values of its channel and a note on forgets the aftertouch of its key.
+// The order of the remaining messages is kept.
+inline size_t thin_controllers(track::Track &track, const ThinOptions &options = DEFAULT_THIN_OPTIONS) {
+    message::Messages &messages = track.messages;
+    StreamState state(options);
+    std::vector<bool> keep(messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) keep[i] = state.apply(messages[i], i);
+    for (const size_t i: state.restored()) keep[i] = true;
+    return remove_unkept(messages, keep);
+};
+
+// Thin every track of a file on its own, or with acrossTracks all tracks as one stream of events:
+// tracks often share channels, so a value set by one track makes the same value in another one
+// redundant. The events of all tracks are then merged by time, events at the same tick keeping the
+// track order, and every track must be sorted by time. A track thinned this way may hold wrong
+// values when played alone (muted or soloed tracks). The independent songs of format 2 files are
+// always thinned per track.
+inline size_t thin_controllers(file::MidiFile &midiFile, const ThinOptions &options = DEFAULT_THIN_OPTIONS) {
+    size_t removed = 0;
+    if (!options.acrossTracks || midiFile.format == file::MidiFormat::MultiSong) {
+        for (auto &track: midiFile.tracks) removed += thin_controllers(track, options);
+        return removed;
+    }
+
+    // events are identified by the offset of their track plus their index
+    const size_t trackNum = midiFile.track_num();
+    std::vector<size_t> offsets(trackNum + 1, 0);
+    for (size_t t = 0; t < trackNum; ++t)
+        offsets[t + 1] = offsets[t] + midiFile.tracks[t].message_num();
+
+    // k-way merge of the sorted tracks on (time, track) of their next event
+    typedef std::pair<message::Time, size_t> Cursor;
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> next;
+    for (size_t t = 0; t < trackNum; ++t) {
+        if (!midiFile.tracks[t].messages.empty()) next.emplace(midiFile.tracks[t].messages[0].get_time(), t);
+    }
+
+    StreamState state(options);
+    std::vector<bool> keep(offsets.back());
+    std::vector<size_t> positions(trackNum, 0);
+    while (!next.empty()) {
+        const size_t t = next.top().second;
+        next.pop();
+        const message::Messages &messages = midiFile.tracks[t].messages;
+        size_t &i = positions[t];
+        // a run of events before the next event of the other tracks needs no queue operations
+        do {
+            keep[offsets[t] + i] = state.apply(messages[i], offsets[t] + i);
+            ++i;
+        } while (i < messages.size() && (next.empty() || Cursor(messages[i].get_time(), t) < next.top()));
+        if (i < messages.size()) next.emplace(messages[i].get_time(), t);
+    }
+    for (const size_t idx: state.restored()) keep[idx] = true;
+
+    for (size_t t = 0; t < trackNum; ++t)
+        removed += remove_unkept(midiFile.tracks[t].messages, keep, offsets[t]);
+    return removed;
+};
+
+}
+
+}
+
+#endif //MINIMIDI_THIN_HPP
@@ -0,0 +1,339 @@
+#ifndef MINIMIDI_TIMING_HPP
+#define MINIMIDI_TIMING_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<vector>
+#include<algorithm>
+#include<numeric>
+#include<utility>
+#include<stdexcept>
+#include"Core.hpp"
+
+namespace minimidi {
+
+namespace timing {
+
+// default tempo of a midi file without any SetTempo event (120 bpm)
+constexpr uint32_t DEFAULT_TEMPO = 500000;
+
+class TempoMap {
+    // A piecewise linear mapping between ticks and seconds,
+    // one segment per tempo change.
+    typedef struct {
+        message::Time tick;
+        double second;
+        double secondPerTick;
+    } Segment;
+
+    std::vector<Segment> segments;
+
+public:
+    // the map of an empty file: 120 bpm at 960 ticks per quarter
+    TempoMap() : TempoMap(file::MidiFile()) {};
+
+    explicit TempoMap(const file::MidiFile &midiFile) {
+        // SMPTE division has a fixed tick length, tempo events are ignored
+        if (midiFile.get_division_type()) {
+            const double tps = midiFile.ticksPerFrame * midiFile.get_frame_per_second();
+            segments.push_back({0, 0., 1. / tps});
+            return;
+        }
+
+        // (tick, tempo)
+        typedef std::pair<message::Time, uint32_t> TempoEvent;
+        std::vector<TempoEvent> tempos;
+        for (const auto &track: midiFile.tracks) {
+            for (const auto &msg: track.messages) {
+                if (msg.get_type() == message::MessageType::Meta &&
+                    msg.get_meta_type() == message::MetaType::SetTempo)
+                    tempos.emplace_back(msg.get_time(), msg.get_tempo());
+            }
+        }
+        // keep the file order of tempo events at the same tick, the last one wins
+        std::stable_sort(tempos.begin(), tempos.end(),
+            [](const TempoEvent &a, const TempoEvent &b) { return a.first < b.first; });
+
+        const double tpq = midiFile.ticksPerQuarter;
+        segments.reserve(tempos.size() + 1);
+        segments.push_back({0, 0., DEFAULT_TEMPO / 1e6 / tpq});
+        for (const auto &[tick, tempo]: tempos) {
+            Segment &last = segments.back();
+            const double secondPerTick = tempo / 1e6 / tpq;
+            if (tick == last.tick) {
+                last.secondPerTick = secondPerTick;
+            } else {
+                segments.push_back({tick, last.second + (tick - last.tick) * last.secondPerTick, secondPerTick});
+            }
+        }
+    };
+
+    [[nodiscard]] double tick_to_second(const message::Time tick) const {
+        const Segment &seg = *(std::upper_bound(segments.begin() + 1, segments.end(), tick,
+            [](const message::Time t, const Segment &s) { return t < s.tick; }) - 1);
+        return seg.second + (tick - seg.tick) * seg.secondPerTick;
+    };
+
+    [[nodiscard]] message::Time second_to_tick(const double second) const {
+        const Segment &seg = *(std::upper_bound(segments.begin() + 1, segments.end(), second,
+            [](const double s, const Segment &seg) { return s < seg.second; }) - 1);
+        if (second <= seg.second) return seg.tick;
+        // after a SetTempo of 0 the time stands still, later seconds are never reached
+        if (!(seg.secondPerTick > 0)) return message::MAX_TIME;
+        const double ticks = (second - seg.second) / seg.secondPerTick + 0.5;
+        if (!(ticks < static_cast<double>(message::MAX_TIME - seg.tick))) return message::MAX_TIME;
+        return seg.tick + static_cast<message::Time>(ticks);
+    };
+
+    // Convert a sorted tick column in a single forward sweep.
+    template<typename InIter, typename OutIter>
+    void ticks_to_seconds(InIter begin, InIter end, OutIter out) const {
+        auto seg = segments.begin();
+        for (; begin != end; ++begin, ++out) {
+            const message::Time tick = *begin;
+            while (seg + 1 != segments.end() && (seg + 1)->tick <= tick) ++seg;
+            *out = seg->second + (tick - seg->tick) * seg->secondPerTick;
+        }
+    }
+
+    [[nodiscard]] size_t tempo_num() const {
+        return this->segments.size();
+    };
+};
+
+// Position of a tick: bar, beat in the bar and tick in the beat, all from 0.
+typedef struct {
+    message::Time bar;
+    uint32_t beat;
+    message::Time tick;
+} BarBeat;
+
+class MeterMap {
+    // One segment per time signature change, which always starts a new bar.
+    // A change in the middle of a bar cuts the bar short.
+    typedef struct {
+        message::Time tick;
+        message::Time bar;
+        uint64_t barLength;
+        uint64_t beatLength;
+        uint32_t beats;
+    } Segment;
+
+    std::vector<Segment> segments;
+
+    [[nodiscard]] BarBeat position(const Segment &seg, const message::Time tick) const {
+        const uint64_t offset = tick - seg.tick;
+        const uint64_t inBar = offset % seg.barLength;
+        const uint32_t beat = static_cast<uint32_t>(std::min<uint64_t>(inBar / seg.beatLength, seg.beats - 1));
+        return {static_cast<message::Time>(seg.bar + offset / seg.barLength), beat,
+                static_cast<message::Time>(inBar - beat * seg.beatLength)};
+    };
+
+public:
+    // the map of an empty file: 4/4 at 960 ticks per quarter
+    MeterMap() : MeterMap(file::MidiFile()) {};
+
+    explicit MeterMap(const file::MidiFile &midiFile) {
+        if (midiFile.get_division_type()) {
+            throw std::invalid_argument("MiniMidi: Bars are undefined for SMPTE division!");
+        }
+
+        // (tick, time signature)
+        typedef std::pair<message::Time, message::TimeSignature> MeterEvent;
+        std::vector<MeterEvent> meters;
+        for (const auto &track: midiFile.tracks) {
+            for (const auto &msg: track.messages) {
+                if (msg.get_type() == message::MessageType::Meta &&
+                    msg.get_meta_type() == message::MetaType::TimeSignature)
+                    meters.emplace_back(msg.get_time(), msg.get_time_signature());
+            }
+        }
+        // keep the file order of time signatures at the same tick, the last one wins
+        std::stable_sort(meters.begin(), meters.end(),
+            [](const MeterEvent &a, const MeterEvent &b) { return a.first < b.first; });
+
+        const uint64_t tpq = midiFile.ticksPerQuarter;
+        segments.reserve(meters.size() + 1);
+        segments.push_back({0, 0, std::max<uint64_t>(1, tpq * 4), std::max<uint64_t>(1, tpq), 4});
+        for (const auto &[tick, timeSig]: meters) {
+            const uint64_t denominator = std::max<uint8_t>(1, timeSig.denominator);
+            const uint64_t barLength = std::max<uint64_t>(1, tpq * 4 * timeSig.numerator / denominator);
+            const uint64_t beatLength = std::max<uint64_t>(1, tpq * 4 / denominator);
+            const uint32_t beats = std::max<uint32_t>(1, timeSig.numerator);
+            const Segment &last = segments.back();
+            if (tick == last.tick) {
+                segments.back() = {last.tick, last.bar, barLength, beatLength, beats};
+            } else {
+                const uint64_t bars = (tick - last.tick + last.barLength - 1) / last.barLength;
+                segments.push_back({tick, static_cast<message::Time>(last.bar + bars), barLength, beatLength, beats});
+            }
+        }
+    };
+
+    [[nodiscard]] BarBeat tick_to_position(const message::Time tick) const {
+        return position(*(std::upper_bound(segments.begin() + 1, segments.end(), tick,
+            [](const message::Time t, const Segment &s) { return t < s.tick; }) - 1), tick);
+    };
+
+    // Tick of a position, saturating at message::MAX_TIME.
+    [[nodiscard]] message::Time position_to_tick(const BarBeat &position) const {
+        const Segment &seg = *(std::upper_bound(segments.begin() + 1, segments.end(), position.bar,
+            [](const message::Time b, const Segment &s) { return b < s.bar; }) - 1);
+        const auto add = [](const message::Time tick, const uint64_t count, const uint64_t length) {
+            if (count && length > (message::MAX_TIME - tick) / count) return message::MAX_TIME;
+            return static_cast<message::Time>(tick + count * length);
+        };
+        return add(add(add(seg.tick, position.bar - seg.bar, seg.barLength),
+            position.beat, seg.beatLength), position.tick, 1);
+    };
+
+    [[nodiscard]] message::Time bar_to_tick(const message::Time bar) const {
+        return this->position_to_tick({bar, 0, 0});
+    };
+
+    // Convert a sorted tick column in a single forward sweep.
+    template<typename InIter, typename OutIter>
+    void ticks_to_positions(InIter begin, InIter end, OutIter out) const {
+        auto seg = segments.begin();
+        for (; begin != end; ++begin, ++out) {
+            const message::Time tick = *begin;
+            while (seg + 1 != segments.end() && (seg + 1)->tick <= tick) ++seg;
+            *out = position(*seg, tick);
+        }
+    }
+
+    [[nodiscard]] size_t meter_num() const {
+        return this->segments.size();
+    };
+};
+
+// Rescale a tick column in place by num / den, rounding to the nearest tick (halves up).
+// Every absolute tick is rounded on its own, so the error stays below half a tick instead
+// of accumulating as it would when rounding deltas. Both terms must fit in 32 bits.
+template<typename Iter>
+void rescale_ticks(Iter begin, Iter end, const uint64_t num, const uint64_t den) {
+    const uint64_t half = den / 2;
+    if (den == 1) {
+        for (; begin != end; ++begin) *begin = static_cast<message::Time>(*begin * num);
+    } else if (!(den & (den - 1))) {
+        // shifts instead of divisions, so that the loop vectorizes
+        uint32_t shift = 0;
+        while ((uint64_t(1) << shift) != den) ++shift;
+        const uint64_t mask = den - 1;
+        for (; begin != end; ++begin) {
+            const uint64_t tick = *begin;
+            *begin = static_cast<message::Time>((tick >> shift) * num + (((tick & mask) * num + half) >> shift));
+        }
+    } else {
+        for (; begin != end; ++begin) {
+            const uint64_t tick = *begin;
+            *begin = static_cast<message::Time>(tick / den * num + ((tick % den) * num + half) / den);
+        }
+    }
+};
+
+// Rewrite all times of a file to a new ticks per quarter, see rescale_ticks.
+// A note shortened to zero ticks keeps one tick, unless the next note of the same key
+// starts on that tick. End of track events stay at or after the last event of their track.
+// The order of messages is kept and sorted tracks stay sorted. Nothing changes when it throws.
+inline void rescale(file::MidiFile &midiFile, const uint16_t ticksPerQuarter) {
+    if (midiFile.get_division_type()) {
+        throw std::invalid_argument("MiniMidi: Can not rescale a file with SMPTE division!");
+    }
+    if (!ticksPerQuarter || !midiFile.ticksPerQuarter) {
+        throw std::invalid_argument("MiniMidi: Ticks per quarter must be positive!");
+    }
+    // the division field holds 15 bits
+    if (ticksPerQuarter > 0x7FFF) {
+        throw std::invalid_argument("MiniMidi: Ticks per quarter must be at most 32767!");
+    }
+    const uint64_t divisor = std::gcd<uint64_t, uint64_t>(ticksPerQuarter, midiFile.ticksPerQuarter);
+    const uint64_t num = ticksPerQuarter / divisor, den = midiFile.ticksPerQuarter / divisor;
+
+    // check all tracks before changing any of them
+    message::Time maxTick = 0;
+    for (const auto &track: midiFile.tracks) {
+        for (const auto &msg: track.messages) maxTick = std::max(maxTick, msg.get_time());
+    }
+    if (maxTick / den > (message::MAX_TIME - num) / num) {
+        throw std::overflow_error("MiniMidi: Rescaled time exceeds the time type!");
+    }
+
+    std::vector<message::Time> ticks;
+    // sounding note ons and rescaled onset of the next note on, per (channel, pitch)
+    std::vector<std::vector<size_t>> sounding(16 * 128);
+    std::vector<message::Time> nextOnset(16 * 128);
+    // (note off, rescaled onset) of the notes shortened to zero ticks
+    std::vector<std::pair<size_t, message::Time>> collapsed;
+
+    for (auto &track: midiFile.tracks) {
+        message::Messages &messages = track.messages;
+        ticks.resize(messages.size());
+        std::transform(messages.begin(), messages.end(), ticks.begin(),
+            [](const message::Message &msg) { return msg.get_time(); });
+        const bool sorted = std::is_sorted(ticks.begin(), ticks.end());
+        rescale_ticks(ticks.begin(), ticks.end(), num, den);
+
+        // only shrinking can close the gap between a note on and its note off,
+        // pair them first in, first out as note::pair_notes does
+        collapsed.clear();
+        if (num < den) {
+            for (auto &slots: sounding) slots.clear();
+            for (size_t i = 0; i < messages.size(); ++i) {
+                const message::Message &msg = messages[i];
+                const message::MessageType type = msg.get_type();
+                if (type != message::MessageType::NoteOn && type != message::MessageType::NoteOff) continue;
+                auto &slots = sounding[msg.get_channel() * 128 + (msg.get_pitch() & 0x7F)];
+                if (type == message::MessageType::NoteOn && msg.get_velocity()) {
+                    slots.push_back(i);
+                } else if (!slots.empty()) {
+                    const size_t on = slots.front();
+                    slots.erase(slots.begin());
+                    if (ticks[i] == ticks[on] && msg.get_time() > messages[on].get_time())
+                        collapsed.emplace_back(i, ticks[on]);
+                }
+            }
+        }
+        if (!collapsed.empty()) {
+            std::fill(nextOnset.begin(), nextOnset.end(), message::MAX_TIME);
+            auto fix = collapsed.rbegin();
+            for (size_t i = messages.size(); i-- > 0;) {
+                const message::Message &msg = messages[i];
+                const message::MessageType type = msg.get_type();
+                if (type != message::MessageType::NoteOn && type != message::MessageType::NoteOff) continue;
+                const size_t key = msg.get_channel() * 128 + (msg.get_pitch() & 0x7F);
+                if (fix != collapsed.rend() && fix->first == i) {
+                    if (fix->second < nextOnset[key]) ticks[i] = fix->second + 1;
+                    ++fix;
+                } else if (type == message::MessageType::NoteOn && msg.get_velocity()) {
+                    nextOnset[key] = ticks[i];
+                }
+            }
+            // the kept tick may move a note off past the end of track
+            const auto isEndOfTrack = [](const message::Message &msg) {
+                return msg.get_type() == message::MessageType::Meta &&
+                    msg.get_meta_type() == message::MetaType::EndOfTrack;
+            };
+            message::Time lastTick = 0;
+            for (size_t i = 0; i < messages.size(); ++i) {
+                if (!isEndOfTrack(messages[i])) lastTick = std::max(lastTick, ticks[i]);
+            }
+            for (size_t i = 0; i < messages.size(); ++i) {
+                if (isEndOfTrack(messages[i])) ticks[i] = std::max(ticks[i], lastTick);
+            }
+        }
+
+        for (size_t i = 0; i < messages.size(); ++i) messages[i].set_time(ticks[i]);
+        if (sorted && !collapsed.empty()) {
+            std::stable_sort(messages.begin(), messages.end(),
+                [](const message::Message &a, const message::Message &b) { return a.get_time() < b.get_time(); });
+        }
+    }
+    midiFile.ticksPerQuarter = ticksPerQuarter;
+};
+
+}
+
+}
+
+#endif //MINIMIDI_TIMING_HPP
@@ -0,0 +1,254 @@
+#ifndef MINIMIDI_TYPES_HPP
+#define MINIMIDI_TYPES_HPP
+
+// Message types, status tables and the byte-level helpers: constexpr, without allocation
+// or exceptions, shared by Core.hpp and the heap-free containers of Fixed.hpp.
+// The MIDI_MESSAGE_TYPE and MIDI_META_TYPE x-macros are undefined at the end of Core.hpp.
+
+#include<cstdint>
+#include<cstddef>
+#include<array>
+#include<type_traits>
+#include<limits>
+
+// Type of the absolute message times in ticks. uint32_t overflows after 2^32 ticks, e.g. a
+// 24 hour recording at 15360 tpq and 120 bpm needs 6.6e9; define MINIMIDI_TIME_TYPE as
+// uint64_t before the first include for such files, at the cost of 8 more bytes per
+// message (see bench/benchtime). It must be the same in all translation units.
+#ifndef MINIMIDI_TIME_TYPE
+#define MINIMIDI_TIME_TYPE uint32_t
+#endif
+
+namespace minimidi {
+
+namespace utils {
+
+// largest delta time a variable length quantity of 4 bytes can hold
+constexpr uint32_t MAX_VARIABLE_LENGTH = 0x0FFFFFFF;
+
+constexpr uint32_t read_variable_length(const uint8_t *&buffer) {
+    uint32_t value = 0;
+
+    for (auto i = 0; i < 4; ++i) {
+        value = (value << 7) + (*buffer & 0x7f);
+        if (!(*buffer & 0x80)) break;
+        buffer++;
+    }
+
+    buffer++;
+    return value;
+};
+
+constexpr uint64_t read_msb_bytes(const uint8_t *buffer, size_t length) {
+    uint64_t res = 0;
+
+    for (auto i = 0; i < length; ++i) {
+        res <<= 8;
+        res += (*(buffer + i));
+    }
+
+    return res;
+};
+
+constexpr void write_msb_bytes(uint8_t *buffer, size_t value, size_t length) {
+    for (auto i = 1; i <= length; ++i) {
+        *buffer = static_cast<uint8_t>((value >> ((length - i) * 8)) & 0xFF);
+        ++buffer;
+    }
+};
+
+constexpr uint8_t calc_variable_length(uint32_t num) {
+    if(num < 0x80)
+        return 1;
+    else if(num < 0x4000)
+        return 2;
+    else if(num < 0x200000)
+        return 3;
+    else
+        return 4;
+};
+
+constexpr void write_variable_length(uint8_t *&buffer, const uint32_t num) {
+    const uint8_t byteNum = calc_variable_length(num);
+
+    for(auto i = 0; i < byteNum - 1; ++i) {
+        *buffer = (num >> (7 * (byteNum - i - 1))) | 0x80;
+        ++buffer;
+    }
+    *buffer = num & 0x7F;
+    ++buffer;
+};
+
+}
+
+namespace message {
+
+// (name, status, length) length 0 for variable length or undefined messages
+#define MIDI_MESSAGE_TYPE                                      \
+    MIDI_MESSAGE_TYPE_MEMBER(Unknown, 0x00, 0)                 \
+    MIDI_MESSAGE_TYPE_MEMBER(NoteOff, 0x80, 3)                 \
+    MIDI_MESSAGE_TYPE_MEMBER(NoteOn, 0x90, 3)                  \
+    MIDI_MESSAGE_TYPE_MEMBER(PolyphonicAfterTouch, 0xA0, 3)    \
+    MIDI_MESSAGE_TYPE_MEMBER(ControlChange, 0xB0, 3)           \
+    MIDI_MESSAGE_TYPE_MEMBER(ProgramChange, 0xC0, 2)           \
+    MIDI_MESSAGE_TYPE_MEMBER(ChannelAfterTouch, 0xD0, 2)       \
+    MIDI_MESSAGE_TYPE_MEMBER(PitchBend, 0xE0, 3)               \
+    MIDI_MESSAGE_TYPE_MEMBER(SysExStart, 0xF0, 0)              \
+    MIDI_MESSAGE_TYPE_MEMBER(QuarterFrame, 0xF1, 2)            \
+    MIDI_MESSAGE_TYPE_MEMBER(SongPositionPointer, 0xF2, 3)     \
+    MIDI_MESSAGE_TYPE_MEMBER(SongSelect, 0xF3, 2)              \
+    MIDI_MESSAGE_TYPE_MEMBER(TuneRequest, 0xF6, 1)             \
+    MIDI_MESSAGE_TYPE_MEMBER(SysExEnd, 0xF7, 1)                \
+    MIDI_MESSAGE_TYPE_MEMBER(TimingClock, 0xF8, 1)             \
+    MIDI_MESSAGE_TYPE_MEMBER(StartSequence, 0xFA, 1)           \
+    MIDI_MESSAGE_TYPE_MEMBER(ContinueSequence, 0xFB, 1)        \
+    MIDI_MESSAGE_TYPE_MEMBER(StopSequence, 0xFC, 1)            \
+    MIDI_MESSAGE_TYPE_MEMBER(ActiveSensing, 0xFE, 1)           \
+    MIDI_MESSAGE_TYPE_MEMBER(Meta, 0xFF, 0)                    \
+
+// (name, status)
+#define MIDI_META_TYPE                                    \
+    MIDI_META_TYPE_MEMBER(SequenceNumber, 0x00)           \
+    MIDI_META_TYPE_MEMBER(Text, 0x01)                     \
+    MIDI_META_TYPE_MEMBER(CopyrightNote, 0x02)            \
+    MIDI_META_TYPE_MEMBER(TrackName, 0x03)                \
+    MIDI_META_TYPE_MEMBER(InstrumentName, 0x04)           \
+    MIDI_META_TYPE_MEMBER(Lyric, 0x05)                    \
+    MIDI_META_TYPE_MEMBER(Marker, 0x06)                   \
+    MIDI_META_TYPE_MEMBER(CuePoint, 0x07)                 \
+    MIDI_META_TYPE_MEMBER(MIDIChannelPrefix, 0x20)        \
+    MIDI_META_TYPE_MEMBER(EndOfTrack, 0x2F)               \
+    MIDI_META_TYPE_MEMBER(SetTempo, 0x51)                 \
+    MIDI_META_TYPE_MEMBER(SMPTEOffset, 0x54)              \
+    MIDI_META_TYPE_MEMBER(TimeSignature, 0x58)            \
+    MIDI_META_TYPE_MEMBER(KeySignature, 0x59)             \
+    MIDI_META_TYPE_MEMBER(SequencerSpecificMeta, 0x7F)    \
+    MIDI_META_TYPE_MEMBER(Unknown, 0xFF)    \
+
+typedef MINIMIDI_TIME_TYPE Time;
+
+static_assert(std::is_unsigned_v<Time> && std::numeric_limits<Time>::digits >= 32,
+              "MiniMidi: MINIMIDI_TIME_TYPE must be an unsigned integer of at least 32 bits!");
+
+constexpr Time MAX_TIME = std::numeric_limits<Time>::max();
+
+constexpr int16_t MIN_PITCHBEND = -8192;
+constexpr int16_t MAX_PITCHBEND = 8191;
+
+
+enum class MessageType : uint8_t {
+#define MIDI_MESSAGE_TYPE_MEMBER(type, status, length) type,
+    MIDI_MESSAGE_TYPE
+#undef MIDI_MESSAGE_TYPE_MEMBER
+};
+
+typedef struct {
+    uint8_t status;
+    MessageType type;
+    uint8_t length;
+} MessageAttr;
+
+static constexpr MessageAttr MESSAGE_ATTRS[] = {
+#define MIDI_MESSAGE_TYPE_MEMBER(type, status, length) {status, MessageType::type, length},
+    MIDI_MESSAGE_TYPE
+#undef MIDI_MESSAGE_TYPE_MEMBER
+};
+
+constexpr const MessageAttr &message_attr(const MessageType &messageType) {
+    return MESSAGE_ATTRS[static_cast<std::underlying_type_t<MessageType>>(messageType)];
+};
+
+// Resolved at compile time, e.g. message_status<MessageType::NoteOn>() == 0x90
+template<MessageType messageType>
+constexpr uint8_t message_status() {
+    return message_attr(messageType).status;
+};
+
+template<MessageType messageType>
+constexpr uint8_t message_length() {
+    return message_attr(messageType).length;
+};
+
+inline constexpr std::array<MessageType, 256> _generate_message_type_table() {
+    std::array<MessageType, 256> LUT{};
+    for(auto &type : LUT) type = MessageType::Unknown;
+    for(const auto &msg_attr : MESSAGE_ATTRS) {
+        if(msg_attr.status < 0xF0)
+            for(auto i = 0; i < 0x10; i++)
+                LUT[msg_attr.status | i] = msg_attr.type;
+        else
+            LUT[msg_attr.status] = msg_attr.type;
+    }
+
+    return LUT;
+};
+
+constexpr auto MESSAGE_TYPE_TABLE = _generate_message_type_table();
+
+// One byte per status: message type in the low 5 bits, length in the high 3 bits,
+// so that type and length of an event come from a single load.
+constexpr uint8_t STATUS_TYPE_MASK = 0x1F;
+constexpr uint8_t STATUS_LENGTH_SHIFT = 5;
+
+static_assert(sizeof(MESSAGE_ATTRS) / sizeof(MessageAttr) <= STATUS_TYPE_MASK + 1,
+              "MiniMidi: Too many message types for the status table!");
+
+inline constexpr std::array<uint8_t, 256> _generate_status_table() {
+    std::array<uint8_t, 256> LUT{};
+    for(auto i = 0; i < 256; i++) {
+        const MessageType type = MESSAGE_TYPE_TABLE[i];
+        LUT[i] = static_cast<uint8_t>(static_cast<uint8_t>(type) | (message_attr(type).length << STATUS_LENGTH_SHIFT));
+    }
+
+    return LUT;
+};
+
+constexpr auto STATUS_TABLE = _generate_status_table();
+
+constexpr MessageType status_to_message_type(const uint8_t status) {
+    return static_cast<MessageType>(STATUS_TABLE[status] & STATUS_TYPE_MASK);
+};
+
+// Total length with status byte of the message started by status, 0 if variable or undefined
+constexpr uint8_t status_to_length(const uint8_t status) {
+    return STATUS_TABLE[status] >> STATUS_LENGTH_SHIFT;
+};
+
+enum class MetaType : uint8_t {
+#define MIDI_META_TYPE_MEMBER(type, status) type = status,
+    MIDI_META_TYPE
+#undef MIDI_META_TYPE_MEMBER
+};
+
+inline constexpr std::array<MetaType, 256> _generate_meta_type_table() {
+    std::array<MetaType, 256> LUT{};
+    for(auto i = 0; i < 256; i++) {
+        switch(i) {
+            #define MIDI_META_TYPE_MEMBER(type, status) \
+                        case (status): LUT[i] = MetaType::type; break;
+                    MIDI_META_TYPE
+            #undef MIDI_META_TYPE_MEMBER
+            default: LUT[i] = MetaType::Unknown;
+        }
+    }
+
+    return LUT;
+};
+
+constexpr auto META_TYPE_TABLE = _generate_meta_type_table();
+
+constexpr MetaType status_to_meta_type(const uint8_t status) {
+    return META_TYPE_TABLE[static_cast<size_t>(status)];
+};
+
+// Text meta types (Text ... CuePoint) the parser can intern
+constexpr bool is_text_meta(const MetaType metaType) {
+    const auto type = static_cast<uint8_t>(metaType);
+    return type >= static_cast<uint8_t>(MetaType::Text) && type <= static_cast<uint8_t>(MetaType::CuePoint);
+};
+
+}
+
+}
+
+#endif //MINIMIDI_TYPES_HPP
@@ -0,0 +1,252 @@
+#ifndef MINIMIDI_VALIDATE_HPP
+#define MINIMIDI_VALIDATE_HPP
+
+#include<cstdint>
+#include<cstddef>
+#include<cstring>
+#include<string>
+#include<vector>
+#include"Core.hpp"
+
+namespace minimidi {
+
+namespace validate {
+
+// Decoding follows the track::Track constructor, which is authoritative: a file reported
+// without fatal errors parses into the same messages.
+
+// (name, fatal) fatal errors stop the scan of the current chunk
+#define MIDI_ERROR_TYPE                                   \
+    MIDI_ERROR_TYPE_MEMBER(InvalidHeader, true)           \
+    MIDI_ERROR_TYPE_MEMBER(InvalidFormat, false)          \
+    MIDI_ERROR_TYPE_MEMBER(TruncatedChunk, true)          \
+    MIDI_ERROR_TYPE_MEMBER(MissingTrack, true)            \
+    MIDI_ERROR_TYPE_MEMBER(InvalidVariableLength, true)   \
+    MIDI_ERROR_TYPE_MEMBER(UnexpectedRunningStatus, true) \
+    MIDI_ERROR_TYPE_MEMBER(UnknownStatus, true)           \
+    MIDI_ERROR_TYPE_MEMBER(TruncatedEvent, true)          \
+    MIDI_ERROR_TYPE_MEMBER(MissingEndOfTrack, false)      \
+    MIDI_ERROR_TYPE_MEMBER(DataAfterEndOfTrack, false)    \
+    MIDI_ERROR_TYPE_MEMBER(UnmatchedNoteOn, false)        \
+    MIDI_ERROR_TYPE_MEMBER(UnmatchedNoteOff, false)       \
+
+enum class ErrorType {
+#define MIDI_ERROR_TYPE_MEMBER(type, fatal) type,
+    MIDI_ERROR_TYPE
+#undef MIDI_ERROR_TYPE_MEMBER
+};
+
+constexpr size_t ERROR_TYPE_NUM = 0
+#define MIDI_ERROR_TYPE_MEMBER(type, fatal) + 1
+    MIDI_ERROR_TYPE
+#undef MIDI_ERROR_TYPE_MEMBER
+;
+
+inline const std::string &error_type_to_string(const ErrorType &errorType) {
+    static const std::string names[] = {
+#define MIDI_ERROR_TYPE_MEMBER(type, fatal) #type,
+        MIDI_ERROR_TYPE
+#undef MIDI_ERROR_TYPE_MEMBER
+    };
+
+    return names[static_cast<int>(errorType)];
+};
+
+inline bool is_fatal(const ErrorType &errorType) {
+    static constexpr bool fatal[] = {
+#define MIDI_ERROR_TYPE_MEMBER(type, fatal) fatal,
+        MIDI_ERROR_TYPE
+#undef MIDI_ERROR_TYPE_MEMBER
+    };
+
+    return fatal[static_cast<int>(errorType)];
+};
+
+#undef MIDI_ERROR_TYPE
+
+class Report {
+public:
+    // occurrences of every error type
+    size_t counts[ERROR_TYPE_NUM]{};
+    // byte offset of the first occurrence of every error type
+    size_t offsets[ERROR_TYPE_NUM]{};
+    uint16_t trackNum = 0;
+    size_t messageNum = 0;
+
+    void add(const ErrorType type, const size_t offset, const size_t count = 1) {
+        const auto idx = static_cast<size_t>(type);
+        if (!counts[idx]) offsets[idx] = offset;
+        counts[idx] += count;
+    };
+
+    [[nodiscard]] size_t count(const ErrorType type) const {
+        return counts[static_cast<size_t>(type)];
+    };
+
+    [[nodiscard]] bool ok() const {
+        for (const size_t c: counts) {
+            if (c) return false;
+        }
+        return true;
+    };
+
+    [[nodiscard]] bool fatal() const {
+        for (size_t i = 0; i < ERROR_TYPE_NUM; ++i) {
+            if (counts[i] && is_fatal(static_cast<ErrorType>(i))) return true;
+        }
+        return false;
+    };
+};
+
+// Read a variable length quantity of at most 4 bytes without reading past end.
+inline bool read_variable_length_checked(const uint8_t *&cursor, const uint8_t *end, uint32_t &value) {
+    value = 0;
+    for (int i = 0; i < 4 && cursor < end; ++i) {
+        const uint8_t byte = *cursor++;
+        value = (value << 7) | (byte & 0x7F);
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+};
+
+// Check the events of a track chunk without materializing messages.
+inline void validate_track(const uint8_t *const data, const size_t size, const size_t baseOffset, Report &report) {
+    const uint8_t *cursor = data;
+    const uint8_t *const end = data + size;
+    uint8_t prevStatus = 0x00;
+    size_t prevEventLen = 0;
+    bool endOfTrack = false;
+    // note ons without note off per (channel, pitch)
+    uint16_t sounding[16 * 128]{};
+
+    const auto fail = [&](const ErrorType type, const uint8_t *at) {
+        report.add(type, baseOffset + (at - data));
+    };
+
+    while (cursor < end) {
+        const uint8_t *eventBegin = cursor;
+        uint32_t delta;
+        if (!read_variable_length_checked(cursor, end, delta)) {
+            fail(ErrorType::InvalidVariableLength, eventBegin);
+            return;
+        }
+        if (cursor >= end) {
+            fail(ErrorType::TruncatedEvent, eventBegin);
+            return;
+        }
+
+        const uint8_t *const statusPtr = cursor;
+        uint8_t status = *cursor;
+        size_t dataLen;
+        if (status < 0x80) {
+            if (!prevEventLen) {
+                fail(ErrorType::UnexpectedRunningStatus, cursor);
+                return;
+            }
+            status = prevStatus;
+            dataLen = prevEventLen - 1;
+        } else if (status == 0xFF || status == 0xF0 || status == 0xF7) {
+            // Meta and SysEx: status, (meta type), variable length, data
+            cursor += status == 0xFF ? 2 : 1;
+            uint32_t len;
+            if (cursor >= end || !read_variable_length_checked(cursor, end, len)) {
+                fail(cursor >= end ? ErrorType::TruncatedEvent : ErrorType::InvalidVariableLength, eventBegin);
+                return;
+            }
+            if (status == 0xF0) {
+                prevStatus = status;
+                prevEventLen = 0;
+            }
+            if (len > static_cast<size_t>(end - cursor)) {
+                fail(ErrorType::TruncatedEvent, eventBegin);
+                return;
+            }
+            ++report.messageNum;
+            cursor += len;
+            if (status == 0xFF && statusPtr[1] == 0x2F) {
+                endOfTrack = true;
+                break;
+            }
+            continue;
+        } else {
+            prevStatus = status;
+            prevEventLen = message::status_to_length(status);
+            if (!prevEventLen) {
+                // undefined status byte, the length is unknown
+                fail(ErrorType::UnknownStatus, cursor);
+                return;
+            }
+            ++cursor;
+            dataLen = prevEventLen - 1;
+        }
+
+        if (dataLen > static_cast<size_t>(end - cursor)) {
+            fail(ErrorType::TruncatedEvent, eventBegin);
+            return;
+        }
+        ++report.messageNum;
+
+        const uint8_t kind = status & 0xF0;
+        if (kind == 0x90 || kind == 0x80) {
+            uint16_t &count = sounding[(status & 0x0F) * 128 + (cursor[0] & 0x7F)];
+            if (kind == 0x90 && cursor[1]) {
+                ++count;
+            } else if (count) {
+                --count;
+            } else {
+                fail(ErrorType::UnmatchedNoteOff, eventBegin);
+            }
+        }
+        cursor += dataLen;
+    }
+
+    if (!endOfTrack) fail(ErrorType::MissingEndOfTrack, end);
+    else if (cursor < end) fail(ErrorType::DataAfterEndOfTrack, cursor);
+
+    size_t unmatched = 0;
+    for (const uint16_t count: sounding) unmatched += count;
+    if (unmatched) report.add(ErrorType::UnmatchedNoteOn, baseOffset + size, unmatched);
+};
+
+// Check a whole midi file: header, chunk lengths, events and note pairing.
+inline Report validate(const uint8_t *const data, const size_t size) {
+    Report report;
+    if (size < 14 || std::memcmp(data, file::MTHD.data(), 4) != 0 || utils::read_msb_bytes(data + 4, 4) != 6) {
+        report.add(ErrorType::InvalidHeader, 0);
+        return report;
+    }
+    if (utils::read_msb_bytes(data + 8, 2) > 2) report.add(ErrorType::InvalidFormat, 8);
+    const auto trackNum = static_cast<uint16_t>(utils::read_msb_bytes(data + 10, 2));
+
+    const uint8_t *cursor = data + 14;
+    const uint8_t *const end = data + size;
+    while (report.trackNum < trackNum) {
+        if (end - cursor < 8) {
+            report.add(ErrorType::MissingTrack, cursor - data, trackNum - report.trackNum);
+            break;
+        }
+        const size_t chunkLen = utils::read_msb_bytes(cursor + 4, 4);
+        if (chunkLen > static_cast<size_t>(end - cursor - 8)) {
+            report.add(ErrorType::TruncatedChunk, cursor - data);
+            break;
+        }
+        // unknown chunks are skipped
+        if (std::memcmp(cursor, track::MTRK.data(), 4) == 0) {
+            validate_track(cursor + 8, chunkLen, cursor + 8 - data, report);
+            ++report.trackNum;
+        }
+        cursor += 8 + chunkLen;
+    }
+
+    return report;
+};
+
+inline Report validate(const container::Bytes &data) {
+    return validate(data.data(), data.size());
+};
+
+}
+
+}
+
+#endif //MINIMIDI_VALIDATE_HPP
@@ -0,0 +1,137 @@
+#ifndef MINIMIDI_C_H
+#define MINIMIDI_C_H
+
+/*
+ * Stable C API of minimidi.
+ *
+ * No function allocates memory or throws: parsing iterates over a caller-provided
+ * buffer and yields events pointing into it, serialization writes into a
+ * caller-provided buffer. All structs are owned by the caller; fields not documented
+ * as public are internal state.
+ */
+
+#include<stdint.h>
+#include<stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    MM_OK = 0,
+    /* iteration finished, not an error */
+    MM_END = 1,
+    MM_ERR_INVALID_ARGUMENT = -1,
+    MM_ERR_INVALID_HEADER = -2,
+    MM_ERR_TRUNCATED = -3,
+    MM_ERR_INVALID_EVENT = -4,
+    MM_ERR_BUFFER_TOO_SMALL = -5,
+    MM_ERR_INTERNAL = -6
+} mm_status;
+
+const char *mm_status_string(mm_status status);
+
+/* ------------------------------ Reading ------------------------------ */
+
+typedef struct {
+    /* public */
+    uint16_t format;
+    uint16_t track_num;
+    /* raw division field of the header, ticks per quarter if the top bit is 0 */
+    uint16_t division;
+    /* internal */
+    const uint8_t *data;
+    size_t size;
+    size_t cursor;
+    uint16_t track_idx;
+} mm_file;
+
+typedef struct {
+    /* public */
+    uint16_t index;
+    /* internal */
+    const uint8_t *cursor;
+    const uint8_t *end;
+    uint32_t time;
+    uint8_t running_status;
+    uint8_t running_length;
+    uint8_t finished;
+} mm_track;
+
+typedef struct {
+    /* absolute time in ticks */
+    uint32_t time;
+    /* status byte, 0xFF for meta events, 0xF0/0xF7 for SysEx */
+    uint8_t status;
+    /* meta type for meta events, 0 otherwise */
+    uint8_t meta_type;
+    /*
+     * channel and system common events: the data bytes after the status byte
+     * meta events: the meta value, after the length prefix
+     * SysEx events: the body, after the length prefix
+     * When reading, data points into the parsed buffer.
+     */
+    const uint8_t *data;
+    size_t size;
+} mm_event;
+
+/* Parse the header of a midi file in data, which must outlive the mm_file and its tracks. */
+mm_status mm_file_open(mm_file *file, const uint8_t *data, size_t size);
+
+/* Next track chunk of the file, unknown chunks are skipped. MM_END after the last track. */
+mm_status mm_file_next_track(mm_file *file, mm_track *track);
+
+/*
+ * Next event of the track, MM_END after the end of track event.
+ * MM_ERR_INVALID_EVENT if the absolute time does not fit in uint32_t.
+ */
+mm_status mm_track_next_event(mm_track *track, mm_event *event);
+
+/* ------------------------------ Writing ------------------------------ */
+
+typedef struct {
+    /* public: bytes written so far */
+    size_t size;
+    /* internal */
+    uint8_t *buffer;
+    size_t capacity;
+    size_t track_begin;
+    uint32_t prev_time;
+    uint8_t prev_status;
+    uint8_t has_end_of_track;
+    uint8_t in_track;
+    uint16_t track_num;
+} mm_writer;
+
+/* Start a midi file in buffer. */
+mm_status mm_writer_init(mm_writer *writer, uint8_t *buffer, size_t capacity, uint16_t format, uint16_t division);
+
+mm_status mm_writer_begin_track(mm_writer *writer);
+
+/*
+ * Append an event of the current track. Events must come in time order, at most
+ * 0x0FFFFFFF ticks (the variable length quantity maximum) after the previous one,
+ * otherwise MM_ERR_INVALID_ARGUMENT is returned.
+ */
+mm_status mm_writer_write_event(mm_writer *writer, const mm_event *event);
+
+/* Close the current track, appending an end of track event if none was written. */
+mm_status mm_writer_end_track(mm_writer *writer);
+
+/* Write the track count into the header. *size receives the file size. */
+mm_status mm_writer_finish(mm_writer *writer, size_t *size);
+
+/* ------------------------------ Whole file ------------------------------ */
+
+/*
+ * Parse a midi file and serialize it again with events sorted by time.
+ * On MM_ERR_BUFFER_TOO_SMALL, *out_size receives the required capacity.
+ * This goes through the C++ containers and allocates internally.
+ */
+mm_status mm_reencode(const uint8_t *in, size_t in_size, uint8_t *out, size_t out_capacity, size_t *out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MINIMIDI_C_H */
@@ -0,0 +1,241 @@
+#include<cstring>
+#include<exception>
+#include"minimidi/minimidi_c.h"
+#include"minimidi/Core.hpp"
+#include"minimidi/Validate.hpp"
+
+using namespace minimidi;
+
+namespace {
+
+bool reserve(mm_writer *writer, const size_t size) {
+    return writer->capacity - writer->size >= size;
+}
+
+void write_vlq(mm_writer *writer, const uint32_t value) {
+    uint8_t *cursor = writer->buffer + writer->size;
+    utils::write_variable_length(cursor, value);
+    writer->size = cursor - writer->buffer;
+}
+
+}
+
+extern "C" {
+
+const char *mm_status_string(const mm_status status) {
+    switch (status) {
+        case MM_OK: return "ok";
+        case MM_END: return "end";
+        case MM_ERR_INVALID_ARGUMENT: return "invalid argument";
+        case MM_ERR_INVALID_HEADER: return "invalid header";
+        case MM_ERR_TRUNCATED: return "unexpected end of data";
+        case MM_ERR_INVALID_EVENT: return "invalid event";
+        case MM_ERR_BUFFER_TOO_SMALL: return "buffer too small";
+        case MM_ERR_INTERNAL: return "internal error";
+    }
+    return "unknown status";
+}
+
+mm_status mm_file_open(mm_file *file, const uint8_t *data, const size_t size) {
+    if (!file || !data) return MM_ERR_INVALID_ARGUMENT;
+    if (size < 14 || std::memcmp(data, file::MTHD.data(), 4) != 0 || utils::read_msb_bytes(data + 4, 4) != 6)
+        return MM_ERR_INVALID_HEADER;
+
+    file->format = static_cast<uint16_t>(utils::read_msb_bytes(data + 8, 2));
+    file->track_num = static_cast<uint16_t>(utils::read_msb_bytes(data + 10, 2));
+    file->division = static_cast<uint16_t>(utils::read_msb_bytes(data + 12, 2));
+    file->data = data;
+    file->size = size;
+    file->cursor = 14;
+    file->track_idx = 0;
+    return MM_OK;
+}
+
+mm_status mm_file_next_track(mm_file *file, mm_track *track) {
+    if (!file || !track) return MM_ERR_INVALID_ARGUMENT;
+    while (file->track_idx < file->track_num) {
+        if (file->size - file->cursor < 8) return MM_ERR_TRUNCATED;
+        const uint8_t *chunk = file->data + file->cursor;
+        const size_t chunkLen = utils::read_msb_bytes(chunk + 4, 4);
+        if (chunkLen > file->size - file->cursor - 8) return MM_ERR_TRUNCATED;
+        file->cursor += 8 + chunkLen;
+        // skip unknown chunk
+        if (std::memcmp(chunk, track::MTRK.data(), 4) != 0) continue;
+
+        track->index = file->track_idx++;
+        track->cursor = chunk + 8;
+        track->end = chunk + 8 + chunkLen;
+        track->time = 0;
+        track->running_status = 0;
+        track->running_length = 0;
+        track->finished = 0;
+        return MM_OK;
+    }
+    return MM_END;
+}
+
+mm_status mm_track_next_event(mm_track *track, mm_event *event) {
+    if (!track || !event) return MM_ERR_INVALID_ARGUMENT;
+    if (track->finished || track->cursor >= track->end) return MM_END;
+
+    const uint8_t *cursor = track->cursor;
+    const uint8_t *const end = track->end;
+    uint32_t delta;
+    if (!validate::read_variable_length_checked(cursor, end, delta)) return MM_ERR_INVALID_EVENT;
+    if (cursor >= end) return MM_ERR_TRUNCATED;
+
+    // absolute time would not fit in uint32_t
+    if (delta > UINT32_MAX - track->time) return MM_ERR_INVALID_EVENT;
+    const uint8_t status = *cursor;
+    event->time = track->time + delta;
+    event->meta_type = 0;
+    if (status < 0x80) {
+        // running status
+        if (!track->running_length) return MM_ERR_INVALID_EVENT;
+        event->status = track->running_status;
+        event->size = track->running_length - 1;
+    } else if (status == 0xFF || status == 0xF0 || status == 0xF7) {
+        cursor += 1;
+        if (status == 0xFF) {
+            if (cursor >= end) return MM_ERR_TRUNCATED;
+            event->meta_type = *cursor++;
+        } else {
+            // SysEx cancels running status
+            track->running_length = 0;
+        }
+        uint32_t len;
+        if (cursor >= end) return MM_ERR_TRUNCATED;
+        if (!validate::read_variable_length_checked(cursor, end, len)) return MM_ERR_INVALID_EVENT;
+        event->status = status;
+        event->size = len;
+    } else {
+        const size_t length = message::status_to_length(status);
+        if (!length) return MM_ERR_INVALID_EVENT;
+        track->running_status = status;
+        track->running_length = static_cast<uint8_t>(length);
+        event->status = status;
+        event->size = length - 1;
+        cursor += 1;
+    }
+
+    if (event->size > static_cast<size_t>(end - cursor)) return MM_ERR_TRUNCATED;
+    event->data = cursor;
+    track->cursor = cursor + event->size;
+    track->time = event->time;
+    if (event->status == 0xFF && event->meta_type == static_cast<uint8_t>(message::MetaType::EndOfTrack))
+        track->finished = 1;
+    return MM_OK;
+}
+
+mm_status mm_writer_init(mm_writer *writer, uint8_t *buffer, const size_t capacity,
+                        const uint16_t format, const uint16_t division) {
+    if (!writer || !buffer) return MM_ERR_INVALID_ARGUMENT;
+    std::memset(writer, 0, sizeof(mm_writer));
+    writer->buffer = buffer;
+    writer->capacity = capacity;
+    if (!reserve(writer, 14)) return MM_ERR_BUFFER_TOO_SMALL;
+
+    std::memcpy(buffer, file::MTHD.data(), 4);
+    utils::write_msb_bytes(buffer + 4, 6, 4);
+    utils::write_msb_bytes(buffer + 8, format, 2);
+    utils::write_msb_bytes(buffer + 10, 0, 2);
+    utils::write_msb_bytes(buffer + 12, division, 2);
+    writer->size = 14;
+    return MM_OK;
+}
+
+mm_status mm_writer_begin_track(mm_writer *writer) {
+    if (!writer || writer->in_track) return MM_ERR_INVALID_ARGUMENT;
+    if (!reserve(writer, 8)) return MM_ERR_BUFFER_TOO_SMALL;
+
+    std::memcpy(writer->buffer + writer->size, track::MTRK.data(), 4);
+    writer->track_begin = writer->size;
+    writer->size += 8;
+    writer->prev_time = 0;
+    writer->prev_status = 0;
+    writer->has_end_of_track = 0;
+    writer->in_track = 1;
+    return MM_OK;
+}
+
+mm_status mm_writer_write_event(mm_writer *writer, const mm_event *event) {
+    if (!writer || !event || !writer->in_track || writer->has_end_of_track ||
+        event->time < writer->prev_time || (event->size && !event->data) || event->status < 0x80)
+        return MM_ERR_INVALID_ARGUMENT;
+
+    const uint8_t status = event->status;
+    const uint32_t delta = event->time - writer->prev_time;
+    if (delta > utils::MAX_VARIABLE_LENGTH) return MM_ERR_INVALID_ARGUMENT;
+    const bool isMeta = status == 0xFF;
+    const bool isSysEx = status == 0xF0 || status == 0xF7;
+    if (isMeta || isSysEx) {
+        if (event->size > 0x0FFFFFFF) return MM_ERR_INVALID_ARGUMENT;
+        const size_t need = utils::calc_variable_length(delta) + 1 + isMeta
+            + utils::calc_variable_length(static_cast<uint32_t>(event->size)) + event->size;
+        if (!reserve(writer, need)) return MM_ERR_BUFFER_TOO_SMALL;
+
+        write_vlq(writer, delta);
+        writer->buffer[writer->size++] = status;
+        if (isMeta) writer->buffer[writer->size++] = event->meta_type;
+        write_vlq(writer, static_cast<uint32_t>(event->size));
+        writer->prev_status = 0;
+        if (isMeta && event->meta_type == static_cast<uint8_t>(message::MetaType::EndOfTrack))
+            writer->has_end_of_track = 1;
+    } else {
+        const size_t length = message::status_to_length(status);
+        if (!length || event->size != length - 1) return MM_ERR_INVALID_ARGUMENT;
+        const bool running = status == writer->prev_status && status < 0xF0;
+        if (!reserve(writer, utils::calc_variable_length(delta) + !running + event->size))
+            return MM_ERR_BUFFER_TOO_SMALL;
+
+        write_vlq(writer, delta);
+        if (!running) writer->buffer[writer->size++] = status;
+        writer->prev_status = status < 0xF0 ? status : 0;
+    }
+    if (event->size) std::memcpy(writer->buffer + writer->size, event->data, event->size);
+    writer->size += event->size;
+    writer->prev_time = event->time;
+    return MM_OK;
+}
+
+mm_status mm_writer_end_track(mm_writer *writer) {
+    if (!writer || !writer->in_track) return MM_ERR_INVALID_ARGUMENT;
+    if (!writer->has_end_of_track) {
+        const mm_event endOfTrack = {writer->prev_time, 0xFF,
+            static_cast<uint8_t>(message::MetaType::EndOfTrack), nullptr, 0};
+        if (const mm_status status = mm_writer_write_event(writer, &endOfTrack); status != MM_OK)
+            return status;
+    }
+    utils::write_msb_bytes(writer->buffer + writer->track_begin + 4,
+        writer->size - writer->track_begin - 8, 4);
+    writer->in_track = 0;
+    ++writer->track_num;
+    return MM_OK;
+}
+
+mm_status mm_writer_finish(mm_writer *writer, size_t *size) {
+    if (!writer || writer->in_track) return MM_ERR_INVALID_ARGUMENT;
+    utils::write_msb_bytes(writer->buffer + 10, writer->track_num, 2);
+    if (size) *size = writer->size;
+    return MM_OK;
+}
+
+mm_status mm_reencode(const uint8_t *in, const size_t in_size, uint8_t *out, const size_t out_capacity, size_t *out_size) {
+    if (!in || !out_size || (!out && out_capacity)) return MM_ERR_INVALID_ARGUMENT;
+    mm_file header;
+    if (const mm_status status = mm_file_open(&header, in, in_size); status != MM_OK) return status;
+    try {
+        file::MidiFile midiFile(in, in_size);
+        const container::Bytes bytes = midiFile.to_bytes();
+        *out_size = bytes.size();
+        if (bytes.size() > out_capacity) return MM_ERR_BUFFER_TOO_SMALL;
+        std::memcpy(out, bytes.data(), bytes.size());
+        return MM_OK;
+    } catch (const std::ios_base::failure &) {
+        return MM_ERR_INVALID_EVENT;
+    } catch (...) {
+        return MM_ERR_INTERNAL;
+    }
+}
+
+}
@@ -0,0 +1,98 @@
+#ifndef MINIMIDI_TOOL_UTILS_HPP
+#define MINIMIDI_TOOL_UTILS_HPP
+
+#include<string>
+#include<stdexcept>
+#include<vector>
+#include<map>
+#include<fstream>
+#include<algorithm>
+#include<filesystem>
+
+namespace tools {
+
+namespace fs = std::filesystem;
+
+// Midi files (.mid/.midi) under a directory, or the paths listed in @<list.txt>, sorted.
+// root is set to the directory, or cleared for a list.
+inline std::vector<fs::path> list_inputs(const std::string &input, fs::path &root) {
+    std::vector<fs::path> paths;
+    if (!input.empty() && input[0] == '@') {
+        std::ifstream list(input.substr(1));
+        for (std::string line; std::getline(list, line);) {
+            if (!line.empty()) paths.emplace_back(line);
+        }
+        root.clear();
+    } else {
+        root = fs::path(input);
+        for (const auto &entry: fs::recursive_directory_iterator(root)) {
+            if (!entry.is_regular_file()) continue;
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".mid" || ext == ".midi") paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+};
+
+// Output path under outDir of every input, keeping the directory structure below root, or for a
+// list, below the deepest directory holding all listed files. A non-empty extension replaces the
+// one of the input. Throws std::invalid_argument when two inputs would write the same output.
+inline std::vector<fs::path> output_paths(const std::vector<fs::path> &paths, const fs::path &root,
+                                          const fs::path &outDir, const std::string &extension = "") {
+    std::vector<fs::path> inputs;
+    inputs.reserve(paths.size());
+    for (const auto &path: paths) inputs.push_back(fs::absolute(path).lexically_normal());
+
+    fs::path base;
+    if (!root.empty()) {
+        base = fs::absolute(root).lexically_normal();
+    } else if (!inputs.empty()) {
+        base = inputs.front().parent_path();
+        for (const auto &input: inputs) {
+            const fs::path dir = input.parent_path();
+            const auto end = std::mismatch(base.begin(), base.end(), dir.begin(), dir.end()).first;
+            fs::path common;
+            for (auto it = base.begin(); it != end; ++it) common /= *it;
+            base = common;
+        }
+    }
+
+    std::vector<fs::path> targets;
+    std::map<fs::path, size_t> owners;
+    targets.reserve(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        fs::path target = outDir / inputs[i].lexically_relative(base);
+        if (!extension.empty()) target.replace_extension(extension);
+        const auto [owner, added] = owners.emplace(target, i);
+        if (!added) {
+            throw std::invalid_argument("Inputs " + paths[owner->second].string() + " and "
+                + paths[i].string() + " would both be written to " + target.string());
+        }
+        targets.push_back(std::move(target));
+    }
+    return targets;
+};
+
+// Value of a numeric command line option, which must be a decimal number in [min, max].
+inline size_t parse_number(const std::string &key, const std::string &value, const size_t min, const size_t max) {
+    size_t end = 0;
+    unsigned long long number = 0;
+    if (!value.empty() && value.find_first_not_of("0123456789") == std::string::npos) {
+        try {
+            number = std::stoull(value, &end);
+        } catch (const std::out_of_range &) {
+            end = 0;
+        }
+    }
+    if (!end || number < min || number > max) {
+        throw std::invalid_argument("Invalid value of " + key + ": " + value + " (expected "
+            + std::to_string(min) + " to " + std::to_string(max) + ")");
+    }
+    return static_cast<size_t>(number);
+};
+
+}
+
+#endif //MINIMIDI_TOOL_UTILS_HPP
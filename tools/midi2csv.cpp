@@ -0,0 +1,117 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ midi2csv.cpp -O3 -std=c++17 -I../include -pthread -o midi2csv
+    ./midi2csv <events|notes> <input> <output> [--tsv] [--seconds] [--no-header] [-j threads]
+```
+input:
+    a midi file, written to the output file ("-" for stdout)
+    a directory (searched recursively for .mid/.midi files) or @<list.txt> with one path per line,
+    converted in parallel into one file per input under the output directory, keeping the
+    directory structure below the input directory or the deepest directory holding all listed files
+*/
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include<map>
+#include<mutex>
+#include<atomic>
+#include<chrono>
+#include"minimidi/MiniMidi.hpp"
+#include"minimidi/Export.hpp"
+#include"minimidi/Parallel.hpp"
+#include"ToolUtils.hpp"
+
+using namespace std;
+using namespace minimidi;
+namespace fs = std::filesystem;
+
+void export_file(const string &mode, const file::MidiFile &midiFile, csv::Writer &writer,
+                 const csv::ExportOptions &options) {
+    if (mode == "events") csv::write_events(writer, midiFile, options);
+    else csv::write_notes(writer, midiFile, options);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 4 || (string(argv[1]) != "events" && string(argv[1]) != "notes")) {
+        std::cout << "Usage: ./midi2csv <events|notes> <input.mid|input_dir|@list.txt> <output|output_dir> "
+                     "[--tsv] [--seconds] [--no-header] [-j threads]" << std::endl;
+        return 0;
+    }
+
+    const string mode = argv[1];
+    const string input = argv[2];
+    const string output = argv[3];
+    csv::ExportOptions options = csv::DEFAULT_EXPORT_OPTIONS;
+    size_t threadNum = 0;
+    for (int i = 4; i < argc; ++i) {
+        const string key = argv[i];
+        if (key == "--tsv") options.delimiter = '\t';
+        else if (key == "--seconds") options.seconds = true;
+        else if (key == "--no-header") options.header = false;
+        else if (key == "-j" && i + 1 < argc) threadNum = stoul(argv[++i]);
+    }
+
+    // single file
+    if (input[0] != '@' && !fs::is_directory(input)) {
+        try {
+            const file::MidiFile midiFile = file::MidiFile::from_file(input);
+            if (output == "-") {
+                csv::Writer writer(stdout);
+                export_file(mode, midiFile, writer, options);
+                writer.close();
+            } else {
+                csv::Writer writer(output);
+                export_file(mode, midiFile, writer, options);
+                writer.close();
+            }
+        } catch (const std::exception &e) {
+            cerr << e.what() << endl;
+            return EXIT_FAILURE;
+        }
+        return 0;
+    }
+
+    fs::path root;
+    const vector<fs::path> paths = tools::list_inputs(input, root);
+    vector<fs::path> targets;
+    try {
+        targets = tools::output_paths(paths, root, output, options.delimiter == '\t' ? ".tsv" : ".csv");
+    } catch (const std::invalid_argument &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    atomic<size_t> bytesIn{0}, bytesOut{0}, failed{0};
+    mutex errorMutex;
+    map<string, size_t> errors;
+
+    const auto begin = chrono::steady_clock::now();
+    parallel::for_each_index(paths.size(), threadNum, [&](const size_t idx, size_t) {
+        const fs::path &path = paths[idx];
+        try {
+            const file::MidiFile midiFile = file::MidiFile::from_file(path.string());
+            const fs::path &target = targets[idx];
+            fs::create_directories(target.parent_path());
+
+            csv::Writer writer(target.string());
+            export_file(mode, midiFile, writer, options);
+            writer.close();
+            bytesIn += fs::file_size(path);
+            bytesOut += writer.size();
+        } catch (const std::exception &e) {
+            ++failed;
+            lock_guard<mutex> lock(errorMutex);
+            ++errors[e.what()];
+        }
+    });
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    cout << "Files: " << paths.size() << " (" << failed << " failed) in " << seconds << " s" << endl;
+    cout << "Throughput: " << paths.size() / seconds << " files/s, "
+         << bytesIn / seconds / (1 << 20) << " MB/s in, "
+         << bytesOut / seconds / (1 << 20) << " MB/s out" << endl;
+    for (const auto &[message, count]: errors) cout << "  [" << count << "] " << message << endl;
+
+    return failed ? 1 : 0;
+}
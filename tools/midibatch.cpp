@@ -0,0 +1,219 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ midibatch.cpp -O3 -std=c++17 -I../include -pthread -o midibatch
+    ./midibatch <operation> <input> <output_dir> [-j threads] [--tpq ticks] [--max-error value] [--memory MB]
+```
+operation:
+    reencode        parse and write back
+    format0         merge all tracks into a single track
+    format1         merge all tracks, then split into a conductor track and one track per channel
+    split-channels  split every track into one track per channel
+    rescale         rescale to the ticks per quarter given by --tpq (1 to 32767, default 480)
+    thin            remove redundant controller, pitch bend and aftertouch events,
+                    allowing the held values to differ by --max-error (0 to 127, default 0)
+    validate        parse only, <output_dir> is ignored
+input:
+    a directory (searched recursively for .mid/.midi files) or @<list.txt> with one path per line,
+    written under <output_dir> keeping the directory structure below the input directory or the
+    deepest directory holding all listed files
+*/
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include<map>
+#include<mutex>
+#include<atomic>
+#include<chrono>
+#include<algorithm>
+#include"minimidi/MiniMidi.hpp"
+#include"minimidi/Parallel.hpp"
+#include"minimidi/Timing.hpp"
+#include"minimidi/Thin.hpp"
+#include"ToolUtils.hpp"
+
+using namespace std;
+using namespace minimidi;
+namespace fs = std::filesystem;
+
+typedef struct {
+    string operation;
+    uint16_t tpq;
+    uint8_t maxError;
+    size_t threadNum;
+    size_t memoryMB;
+} Options;
+
+bool is_channel_message(const message::Message &msg) {
+    return msg.get_status_byte() < 0xF0;
+}
+
+bool is_end_of_track(const message::Message &msg) {
+    return msg.get_type() == message::MessageType::Meta && msg.get_meta_type() == message::MetaType::EndOfTrack;
+}
+
+message::Messages merge_tracks(const track::Tracks &tracks) {
+    message::Messages messages;
+    size_t num = 0;
+    for (const auto &track: tracks) num += track.message_num();
+    messages.reserve(num);
+    for (const auto &track: tracks) {
+        const size_t mid = messages.size();
+        for (const auto &msg: track.messages) {
+            if (!is_end_of_track(msg)) messages.push_back(msg);
+        }
+        std::inplace_merge(messages.begin(), messages.begin() + static_cast<long>(mid), messages.end(),
+            [](const message::Message &a, const message::Message &b) { return a.get_time() < b.get_time(); });
+    }
+    return messages;
+}
+
+// Split messages into a track of non-channel messages followed by one track per used channel.
+void split_channels(const message::Messages &messages, track::Tracks &out) {
+    track::Track others;
+    track::Track channels[16];
+    for (const auto &msg: messages) {
+        if (is_end_of_track(msg)) continue;
+        if (is_channel_message(msg)) channels[msg.get_channel()].messages.push_back(msg);
+        else others.messages.push_back(msg);
+    }
+    if (!others.messages.empty()) out.emplace_back(std::move(others));
+    for (auto &channel: channels) {
+        if (!channel.messages.empty()) out.emplace_back(std::move(channel));
+    }
+}
+
+file::MidiFile convert(file::MidiFile &&midiFile, const Options &options) {
+    const string &op = options.operation;
+    if (op == "reencode" || op == "validate") return std::move(midiFile);
+
+    file::MidiFile result(midiFile.format, midiFile.divisionType, midiFile.ticksPerQuarter);
+    if (op == "format0") {
+        result.format = file::MidiFormat::SingleTrack;
+        result.tracks.emplace_back(merge_tracks(midiFile.tracks));
+    } else if (op == "format1") {
+        result.format = file::MidiFormat::MultiTrack;
+        split_channels(merge_tracks(midiFile.tracks), result.tracks);
+    } else if (op == "split-channels") {
+        result.format = file::MidiFormat::MultiTrack;
+        for (const auto &track: midiFile.tracks) split_channels(track.messages, result.tracks);
+    } else if (op == "rescale") {
+        result.tracks = std::move(midiFile.tracks);
+        timing::rescale(result, options.tpq);
+    } else if (op == "thin") {
+        result.tracks = std::move(midiFile.tracks);
+        thin::thin_controllers(result, {options.maxError, true, true, true, false});
+    } else {
+        throw std::invalid_argument("Unknown operation: " + op);
+    }
+    return result;
+}
+
+// Error class of an exception message, with numbers masked so that similar errors are counted together.
+string error_class(const string &message) {
+    string result;
+    for (const char c: message) {
+        if (!isdigit(static_cast<unsigned char>(c))) result.push_back(c);
+        else if (result.empty() || result.back() != '#') result.push_back('#');
+    }
+    return result;
+}
+
+void print_usage(ostream &out) {
+    out << "Usage: ./midibatch <reencode|format0|format1|split-channels|rescale|thin|validate> "
+           "<input_dir|@list.txt> <output_dir> [-j threads] [--tpq ticks] [--max-error value] [--memory MB]" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 4) {
+        print_usage(cout);
+        return 0;
+    }
+
+    Options options{argv[1], 480, 0, 0, 1024};
+    const string input = argv[2];
+    const fs::path outDir = argv[3];
+    try {
+        const vector<string> operations = {
+            "reencode", "format0", "format1", "split-channels", "rescale", "thin", "validate"};
+        if (find(operations.begin(), operations.end(), options.operation) == operations.end()) {
+            throw invalid_argument("Unknown operation: " + options.operation);
+        }
+        for (int i = 4; i < argc; i += 2) {
+            const string key = argv[i];
+            if (i + 1 == argc) throw invalid_argument("Missing value of " + key);
+            const string value = argv[i + 1];
+            if (key == "-j") options.threadNum = tools::parse_number(key, value, 0, 4096);
+            // the division field holds 15 bits
+            else if (key == "--tpq") options.tpq = static_cast<uint16_t>(tools::parse_number(key, value, 1, 0x7FFF));
+            // in 7 bit controller units
+            else if (key == "--max-error") options.maxError = static_cast<uint8_t>(tools::parse_number(key, value, 0, 127));
+            else if (key == "--memory") options.memoryMB = tools::parse_number(key, value, 0, SIZE_MAX >> 20);
+            else throw invalid_argument("Unknown option: " + key);
+        }
+    } catch (const invalid_argument &e) {
+        cerr << e.what() << endl;
+        print_usage(cerr);
+        return EXIT_FAILURE;
+    }
+    const bool writeOutput = options.operation != "validate";
+
+    fs::path root;
+    const vector<fs::path> paths = tools::list_inputs(input, root);
+    vector<fs::path> targets;
+    if (writeOutput) {
+        try {
+            targets = tools::output_paths(paths, root, outDir);
+        } catch (const invalid_argument &e) {
+            cerr << e.what() << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // a parsed file takes several times its size, count input, messages and output
+    constexpr size_t MEMORY_FACTOR = 8;
+    parallel::Budget budget(options.memoryMB << 20);
+    atomic<size_t> bytesIn{0}, bytesOut{0}, failed{0};
+    mutex errorMutex;
+    // error class -> (count, example path)
+    map<string, pair<size_t, string>> errors;
+
+    const auto begin = chrono::steady_clock::now();
+    parallel::for_each_index(paths.size(), options.threadNum, [&](const size_t idx, size_t) {
+        const fs::path &path = paths[idx];
+        size_t cost = 0;
+        try {
+            const size_t fileSize = fs::file_size(path);
+            cost = fileSize * MEMORY_FACTOR;
+            budget.acquire(cost);
+
+            file::MidiFile result = convert(file::MidiFile::from_file(path.string()), options);
+            bytesIn += fileSize;
+            if (writeOutput) {
+                const fs::path &target = targets[idx];
+                fs::create_directories(target.parent_path());
+                result.write_file(target.string());
+                bytesOut += fs::file_size(target);
+            }
+        } catch (const std::exception &e) {
+            ++failed;
+            lock_guard<mutex> lock(errorMutex);
+            auto &[count, example] = errors[error_class(e.what())];
+            if (!count++) example = path.string();
+        }
+        if (cost) budget.release(cost);
+    });
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    cout << "Files: " << paths.size() << " (" << failed << " failed) in " << seconds << " s" << endl;
+    cout << "Throughput: " << paths.size() / seconds << " files/s, "
+         << bytesIn / seconds / (1 << 20) << " MB/s in";
+    if (writeOutput) cout << ", " << bytesOut / seconds / (1 << 20) << " MB/s out";
+    cout << endl;
+    for (const auto &[message, info]: errors) {
+        cout << "  [" << info.first << "] " << message << " (e.g. " << info.second << ")" << endl;
+    }
+
+    return failed ? 1 : 0;
+}
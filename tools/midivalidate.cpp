@@ -0,0 +1,106 @@
+/*
+----------------------------- Usage ----------------------------
+```
+    g++ midivalidate.cpp -O3 -std=c++17 -I../include -pthread -o midivalidate
+    ./midivalidate <input_dir|@list.txt> [-j threads] [--examples N]
+```
+Check header, chunk lengths, running status, variable lengths, end of track
+and note pairing of every file, and print the count of files per error class.
+*/
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include<mutex>
+#include<atomic>
+#include<chrono>
+#include<cstdio>
+#include"minimidi/MiniMidi.hpp"
+#include"minimidi/Parallel.hpp"
+#include"minimidi/Validate.hpp"
+#include"ToolUtils.hpp"
+
+using namespace std;
+using namespace minimidi;
+namespace fs = std::filesystem;
+
+bool read_file(const fs::path &path, container::Bytes &buffer) {
+    FILE *filePtr = fopen(path.string().c_str(), "rb");
+    if (!filePtr) return false;
+    fseek(filePtr, 0, SEEK_END);
+    const long fileLen = ftell(filePtr);
+    fseek(filePtr, 0, SEEK_SET);
+    buffer.resize(fileLen < 0 ? 0 : fileLen);
+    const size_t readLen = fread(buffer.data(), 1, buffer.size(), filePtr);
+    fclose(filePtr);
+    return readLen == buffer.size();
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::cout << "Usage: ./midivalidate <input_dir|@list.txt> [-j threads] [--examples N]" << std::endl;
+        return 0;
+    }
+
+    size_t threadNum = parallel::default_thread_num();
+    size_t exampleNum = 3;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const string key = argv[i];
+        if (key == "-j") threadNum = max<size_t>(1, stoul(argv[i + 1]));
+        else if (key == "--examples") exampleNum = stoul(argv[i + 1]);
+    }
+
+    fs::path root;
+    const vector<fs::path> paths = tools::list_inputs(argv[1], root);
+
+    // one reusable read buffer per worker
+    vector<container::Bytes> buffers(threadNum);
+    atomic<size_t> bytesIn{0}, messageNum{0}, validNum{0}, unreadableNum{0};
+    // files and occurrences per error type
+    atomic<size_t> fileCounts[validate::ERROR_TYPE_NUM]{};
+    atomic<size_t> occurrences[validate::ERROR_TYPE_NUM]{};
+    mutex exampleMutex;
+    vector<vector<string>> examples(validate::ERROR_TYPE_NUM);
+
+    const auto begin = chrono::steady_clock::now();
+    parallel::for_each_index(paths.size(), threadNum, [&](const size_t idx, const size_t worker) {
+        container::Bytes &buffer = buffers[worker];
+        if (!read_file(paths[idx], buffer)) {
+            ++unreadableNum;
+            return;
+        }
+        bytesIn += buffer.size();
+
+        const validate::Report report = validate::validate(buffer);
+        messageNum += report.messageNum;
+        if (report.ok()) {
+            ++validNum;
+            return;
+        }
+        for (size_t e = 0; e < validate::ERROR_TYPE_NUM; ++e) {
+            if (!report.counts[e]) continue;
+            ++fileCounts[e];
+            occurrences[e] += report.counts[e];
+            lock_guard<mutex> lock(exampleMutex);
+            if (examples[e].size() < exampleNum)
+                examples[e].push_back(paths[idx].string() + " @" + to_string(report.offsets[e]));
+        }
+    });
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    cout << "Files: " << paths.size() << " (" << validNum << " valid, "
+         << unreadableNum << " unreadable) in " << seconds << " s" << endl;
+    cout << "Throughput: " << paths.size() / seconds << " files/s, "
+         << bytesIn / seconds / (1 << 20) << " MB/s, "
+         << messageNum / seconds / 1e6 << " M messages/s" << endl;
+    for (size_t e = 0; e < validate::ERROR_TYPE_NUM; ++e) {
+        if (!fileCounts[e]) continue;
+        const auto type = static_cast<validate::ErrorType>(e);
+        cout << "  " << validate::error_type_to_string(type)
+             << (validate::is_fatal(type) ? " (fatal)" : "")
+             << ": " << fileCounts[e] << " files, " << occurrences[e] << " occurrences" << endl;
+        for (const auto &example: examples[e]) cout << "      " << example << endl;
+    }
+
+    return validNum + unreadableNum == paths.size() && !unreadableNum ? 0 : 1;
+}